@@ -11,6 +11,7 @@
 #include "core/templates/ring_buffer.h"
 
 #include "modules/noise/fastnoise_lite.h"	// inherits from noise class in noise.h
+#include "terrain_trace.h"
 #include "scene/resources/image_texture.h"
 #include "scene/resources/3d/primitive_meshes.h"
 
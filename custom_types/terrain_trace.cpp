@@ -0,0 +1,99 @@
+#include "terrain_trace.h"
+
+#include "core/io/file_access.h"
+#include "core/io/json.h"
+
+std::atomic_bool TerrainTrace::enabled = { false };
+Mutex TerrainTrace::registry_mutex;
+LocalVector<TerrainTrace::ThreadBuffer *> TerrainTrace::buffers;
+thread_local TerrainTrace::ThreadBuffer *TerrainTrace::thread_buffer = nullptr;
+
+TerrainTrace::ThreadBuffer *TerrainTrace::register_thread() {
+	ThreadBuffer *buffer = memnew(ThreadBuffer);
+	buffer->thread_id = Thread::get_caller_id();
+	buffer->main_thread = Thread::is_main_thread();
+	{
+		MutexLock lock(registry_mutex);
+		buffers.push_back(buffer);
+	}
+	thread_buffer = buffer;
+	return buffer;
+}
+
+/*
+* buffers keep being written while exporting -> events that may have been overwritten during the copy are dropped
+*/
+String TerrainTrace::to_json() {
+	Array trace_events;
+	MutexLock lock(registry_mutex);
+
+	for (uint32_t b = 0; b < buffers.size(); b++) {
+		ThreadBuffer *buffer = buffers[b];
+		const uint64_t head = buffer->head.load(std::memory_order_acquire);
+		const uint64_t first = MAX(head > CAPACITY ? head - CAPACITY : 0, buffer->cleared.load(std::memory_order_relaxed));
+
+		LocalVector<Event> copied;
+		copied.resize(head - first);
+		for (uint64_t i = first; i < head; i++) {
+			copied[i - first] = buffer->events[i % CAPACITY];
+		}
+		// the writer may already be filling slot head_after % CAPACITY -> that slot's oldest event is dropped too
+		// fence keeps the copy above from being reordered past the second head load
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const uint64_t head_after = buffer->head.load(std::memory_order_relaxed);
+		const uint64_t valid_from = head_after + 1 > CAPACITY ? head_after + 1 - CAPACITY : 0;
+
+		Dictionary thread_name;
+		thread_name["name"] = "thread_name";
+		thread_name["ph"] = "M";
+		thread_name["pid"] = 1;
+		thread_name["tid"] = buffer->thread_id;
+		Dictionary thread_args;
+		thread_args["name"] = buffer->main_thread ? String("main") : vformat("worker %d", b);
+		thread_name["args"] = thread_args;
+		trace_events.push_back(thread_name);
+
+		for (uint64_t i = MAX(first, valid_from); i < head; i++) {
+			const Event &event = copied[i - first];
+			Dictionary e;
+			e["name"] = event.name;
+			e["cat"] = "terrain";
+			e["ph"] = "X";
+			e["ts"] = event.begin_usec;
+			e["dur"] = event.end_usec - event.begin_usec;
+			e["pid"] = 1;
+			e["tid"] = buffer->thread_id;
+			trace_events.push_back(e);
+		}
+	}
+	Dictionary trace;
+	trace["traceEvents"] = trace_events;
+	trace["displayTimeUnit"] = "ms";
+	return JSON::stringify(trace);
+}
+
+Error TerrainTrace::save(const String &p_file) {
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_file, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot write terrain trace: " + p_file);
+	f->store_string(to_json());
+	return OK;
+}
+
+// head is only ever written by its thread -> clearing moves the export start instead of resetting it
+void TerrainTrace::clear() {
+	MutexLock lock(registry_mutex);
+	for (ThreadBuffer *buffer : buffers) {
+		buffer->cleared.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+	}
+}
+
+void TerrainTrace::finalize() {
+	enabled.store(false);
+	thread_buffer = nullptr;
+	MutexLock lock(registry_mutex);
+	for (ThreadBuffer *buffer : buffers) {
+		memdelete(buffer);
+	}
+	buffers.clear();
+}
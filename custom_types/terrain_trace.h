@@ -0,0 +1,87 @@
+#pragma once
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/os/mutex.h"
+#include "core/templates/local_vector.h"
+
+#include <atomic>
+
+/*
+* PIPELINE TRACE -> scoped begin/end events, exported as Chrome/Perfetto trace JSON
+*
+* every thread writes into its own ring buffer (single producer, no locks, oldest events are overwritten)
+* disabled tracing costs one relaxed atomic load per scope, so it stays compiled into release builds
+* names must be string literals -> only the pointer is stored
+*/
+class TerrainTrace {
+public:
+    struct Event {
+        const char *name = nullptr;
+        uint64_t begin_usec = 0;
+        uint64_t end_usec = 0;
+    };
+    // per thread -> 16k events (~384KB), a few seconds of a saturated worker
+    static constexpr uint32_t CAPACITY = 1 << 14;
+
+    struct ThreadBuffer {
+        Thread::ID thread_id;
+        bool main_thread = false;
+        // total events ever written -> slot is head % CAPACITY, published with release
+        std::atomic<uint64_t> head = { 0 };
+        // head at the last clear() -> only the exporting side writes it, writers never race a reset of head
+        std::atomic<uint64_t> cleared = { 0 };
+        Event events[CAPACITY];
+    };
+
+private:
+    static std::atomic_bool enabled;
+    // registry is only locked the first time a thread records and while exporting
+    static Mutex registry_mutex;
+    static LocalVector<ThreadBuffer *> buffers;
+    static thread_local ThreadBuffer *thread_buffer;
+
+    static ThreadBuffer *register_thread();
+
+public:
+    static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+    static void set_enabled(bool p_enabled) { enabled.store(p_enabled, std::memory_order_relaxed); }
+
+    static void record(const char *p_name, uint64_t p_begin_usec, uint64_t p_end_usec) {
+        ThreadBuffer *buffer = thread_buffer != nullptr ? thread_buffer : register_thread();
+        const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+        Event &event = buffer->events[head % CAPACITY];
+        event.name = p_name;
+        event.begin_usec = p_begin_usec;
+        event.end_usec = p_end_usec;
+        buffer->head.store(head + 1, std::memory_order_release);
+    }
+
+    // events still in the ring buffers -> Chrome trace event format ("X" complete events)
+    static String to_json();
+    static Error save(const String &p_file);
+    static void clear();
+    // frees every thread buffer -> only on module uninitialization, after all workers have stopped
+    static void finalize();
+};
+
+
+class TerrainTraceScope {
+    const char *name;
+    uint64_t begin_usec = 0;
+
+public:
+    explicit TerrainTraceScope(const char *p_name) : name(p_name) {
+        if (TerrainTrace::is_enabled()) {
+            begin_usec = OS::get_singleton()->get_ticks_usec();
+        }
+    }
+    ~TerrainTraceScope() {
+        // enabled mid-scope -> no begin time, dropped
+        if (begin_usec != 0 && TerrainTrace::is_enabled()) {
+            TerrainTrace::record(name, begin_usec, OS::get_singleton()->get_ticks_usec());
+        }
+    }
+};
+
+#define TERRAIN_TRACE_SCOPE(m_name) TerrainTraceScope _terrain_trace_scope(m_name)
@@ -0,0 +1,94 @@
+#include "deformation_layer.h"
+
+Rect2 DeformationLayer::apply(const Edit &p_edit, const HashMap<Vector3, Ref<HeightMapData>> &p_resident, HashSet<Vector3> &r_dirty_chunks) {
+	const real_t step = WorldData::STEP_SIZE;
+	const int resolution = WorldData::H_RESOLUTION;
+	const Rect2 world_rect(p_edit.center.x - p_edit.radius, p_edit.center.z - p_edit.radius, p_edit.radius * 2.0, p_edit.radius * 2.0);
+
+	// padding pixels overlap neighbouring chunks -> every chunk whose image covers the rect is edited
+	const int cx_begin = Math::floor(world_rect.position.x / WorldData::LENGTH) - 1;
+	const int cx_end = Math::ceil(world_rect.get_end().x / WorldData::LENGTH) + 1;
+	const int cz_begin = Math::floor(world_rect.position.y / WorldData::LENGTH) - 1;
+	const int cz_end = Math::ceil(world_rect.get_end().y / WorldData::LENGTH) + 1;
+
+	for (int cz = cz_begin; cz <= cz_end; cz++) {
+		for (int cx = cx_begin; cx <= cx_end; cx++) {
+			const Vector3 chunk_pos(cx, 0, cz);
+			const Vector3 start = HeightMapData::chunk_start_pos(chunk_pos);
+
+			const int i_begin = MAX(0, int(Math::ceil((world_rect.position.x - start.x) / step)));
+			const int i_end = MIN(resolution - 1, int(Math::floor((world_rect.get_end().x - start.x) / step)));
+			const int j_begin = MAX(0, int(Math::ceil((world_rect.position.y - start.z) / step)));
+			const int j_end = MIN(resolution - 1, int(Math::floor((world_rect.get_end().y - start.z) / step)));
+			if (i_begin > i_end || j_begin > j_end) {
+				continue;
+			}
+
+			// non-resident chunks only get the delta -> their padding pixels still match once they load
+			const Ref<HeightMapData> *resident = p_resident.getptr(chunk_pos);
+			Ref<HeightDelta> &delta = deltas[chunk_pos];
+			if (delta.is_null() || !delta->matches_resolution()) {
+				delta.instantiate();
+			}
+			float *scales = delta->scales_ptrw();
+			float *offsets = delta->ptrw();
+			float *pixels = resident != nullptr ? reinterpret_cast<float *>((*resident)->get_image()->ptrw()) : nullptr;
+
+			for (int j = j_begin; j <= j_end; j++) {
+				const real_t z = start.z + j * step;
+				for (int i = i_begin; i <= i_end; i++) {
+					const real_t x = start.x + i * step;
+					const real_t distance = Vector2(x - p_edit.center.x, z - p_edit.center.z).length();
+					if (distance >= p_edit.radius) {
+						continue;
+					}
+					// smooth falloff -> 1 at the center, 0 with zero slope at the radius
+					real_t weight = 1.0 - (distance * distance) / (p_edit.radius * p_edit.radius);
+					weight *= weight;
+
+					const int index = j * resolution + i;
+					if (p_edit.mode == EDIT_RAISE) {
+						offsets[index] += p_edit.amount * weight;
+					}
+					else {
+						// target height, not a delta from the current one -> exact once coarse heights are refined
+						scales[index] *= 1.0 - weight;
+						offsets[index] = offsets[index] * (1.0 - weight) + p_edit.amount * weight;
+					}
+					if (pixels != nullptr) {
+						const double current = HeightMapData::true_height(pixels[index]);
+						const double edited = p_edit.mode == EDIT_RAISE ? current + p_edit.amount * weight : Math::lerp(current, (double)p_edit.amount, (double)weight);
+						pixels[index] = HeightMapData::inverse_true_height(edited);
+					}
+				}
+			}
+			delta->expand_bounds(Rect2i(i_begin, j_begin, i_end - i_begin + 1, j_end - j_begin + 1));
+			if (resident != nullptr) {
+				r_dirty_chunks.insert(chunk_pos);
+			}
+		}
+	}
+	return world_rect;
+}
+
+void DeformationLayer::compose(const Ref<HeightMapData> &p_hmap_data, const Vector3 &chunk_pos) const {
+	const Ref<HeightDelta> *delta = deltas.getptr(chunk_pos);
+	if (delta == nullptr || !(*delta)->matches_resolution()) {
+		return;
+	}
+	const int resolution = WorldData::H_RESOLUTION;
+	const Rect2i bounds = (*delta)->get_bounds();
+	const float *scales = (*delta)->scales_ptr();
+	const float *offsets = (*delta)->ptr();
+	float *pixels = reinterpret_cast<float *>(p_hmap_data->get_image()->ptrw());
+
+	for (int j = bounds.position.y; j < bounds.get_end().y; j++) {
+		for (int i = bounds.position.x; i < bounds.get_end().x; i++) {
+			const int index = j * resolution + i;
+			if (scales[index] == 1.0 && offsets[index] == 0.0) {
+				continue;
+			}
+			pixels[index] = HeightMapData::inverse_true_height(HeightMapData::true_height(pixels[index]) * scales[index] + offsets[index]);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "height_map_data.h"
+
+/*
+* per chunk world space height changes -> only chunks that were edited own one
+* every edit is affine in the height, so any sequence of them is stored per pixel as height * scale + offset
+* -> raise only moves the offset, flatten pulls scale towards 0 and the offset towards its target height
+* survives chunk eviction and is composed over freshly generated (or refined) heights
+*/
+class HeightDelta : public RefCounted {
+	GDCLASS(HeightDelta, RefCounted);
+
+    Vector<float> scales;
+    Vector<float> offsets;
+    // pixels touched so far -> composition only walks this rect
+    Rect2i bounds;
+    int resolution = 0;
+
+public:
+    bool matches_resolution() const { return resolution == WorldData::H_RESOLUTION; }
+    Rect2i get_bounds() const { return bounds; }
+    const float *ptr() const { return offsets.ptr(); }
+    float *ptrw() { return offsets.ptrw(); }
+    const float *scales_ptr() const { return scales.ptr(); }
+    float *scales_ptrw() { return scales.ptrw(); }
+    void expand_bounds(const Rect2i &p_rect) { bounds = bounds.has_area() ? bounds.merge(p_rect) : p_rect; }
+
+    HeightDelta() {
+        resolution = WorldData::H_RESOLUTION;
+        scales.resize(resolution * resolution);
+        scales.fill(1.0);
+        offsets.resize(resolution * resolution);
+        offsets.fill(0.0);
+    }
+};
+
+
+/*
+* SPARSE DEFORMATION LAYER -> main thread only
+*
+* edits change resident heightmaps in place (only the touched pixel rect) and accumulate the same
+* change into the chunk's HeightDelta, so chunks generated later come back with the edit applied
+*/
+class DeformationLayer {
+    HashMap<Vector3, Ref<HeightDelta>> deltas;
+
+public:
+    enum EditMode {
+        EDIT_RAISE,		// amount -> added height at the center, negative digs
+        EDIT_FLATTEN,	// amount -> target height, also recorded for chunks that are not resident
+    };
+    struct Edit {
+        EditMode mode = EDIT_RAISE;
+        Vector3 center;
+        real_t radius = 0.0;
+        real_t amount = 0.0;
+    };
+
+    /*
+    * r_dirty_chunks -> resident chunks whose heightmap changed and needs re-uploading
+    * returns the touched world rect (xz) for collision updates
+    */
+    Rect2 apply(const Edit &p_edit, const HashMap<Vector3, Ref<HeightMapData>> &p_resident, HashSet<Vector3> &r_dirty_chunks);
+    // generated heights + stored offsets -> called once per chunk when it becomes resident
+    void compose(const Ref<HeightMapData> &p_hmap_data, const Vector3 &chunk_pos) const;
+
+    bool has_delta(const Vector3 &chunk_pos) const { return deltas.has(chunk_pos); }
+    int get_delta_count() const { return deltas.size(); }
+    void clear() { deltas.clear(); }
+};
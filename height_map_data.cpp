@@ -4,6 +4,7 @@
 // DEFINE STATIC VALUES
 RID WorldData::world_scenario;
 Ref<Shader> WorldData::terrain_shader;
+Ref<HeightSource> WorldData::height_source;
 
 int WorldData::SEED;
 real_t WorldData::HEIGHT_EXP;
@@ -16,6 +17,7 @@ real_t WorldData::LOD_LIMIT;
 
 Vector3 WorldData::WORLD_OFFSET;
 int WorldData::H_RESOLUTION;
+int WorldData::TILE_SIZE = 32;
 
 FastNoiseLite::NoiseType WorldData::noise_type;
 FastNoiseLite::FractalType WorldData::fractal_type;
@@ -24,6 +26,19 @@ real_t WorldData::FRACTAL_OCTAVES;
 real_t WorldData::FRACTAL_LACUNARITY;
 real_t WorldData::FRACTAL_GAIN;
 
+// scatter defaults -> not reset in _enter_tree, so values set from gdscript beforehand are kept
+RID WorldData::SCATTER_MESH;
+real_t WorldData::SCATTER_SPACING = 8.0;
+real_t WorldData::SCATTER_DENSITY = 0.5;
+real_t WorldData::SCATTER_MIN_HEIGHT = 1.0;
+real_t WorldData::SCATTER_MAX_HEIGHT = 1e6;
+real_t WorldData::SCATTER_MAX_SLOPE = 0.7;
+real_t WorldData::SCATTER_MIN_SCALE = 0.8;
+real_t WorldData::SCATTER_MAX_SCALE = 1.2;
+
+HashMap<int, Ref<ArrayMesh>> MeshData::lod_mesh_cache;
+Vector2 MeshData::lod_mesh_cache_key;
+
 
 HeightMapData::HeightMapData() {
 }
@@ -33,7 +48,7 @@ HeightMapData::HeightMapData(Vector3 new_pos, Callable p_callable) {
 HeightMapData::~HeightMapData() {
 }
 
-void HeightMapData::setup_height_map(Size2 size, Vector3 position) {
+void HeightMapData::set_bounds(Size2 size, Vector3 position) {
 	// maximum vertex count (subdivide_w * subdivide_d)
 	subdivide_w = (WorldData::LENGTH / WorldData::STEP_SIZE) + 1.0;
 	subdivide_d = (WorldData::LENGTH / WorldData::STEP_SIZE) + 1.0;
@@ -48,70 +63,325 @@ void HeightMapData::setup_height_map(Size2 size, Vector3 position) {
 	* FORMAT_RH (16-bit float) -> a good balance between size and accuracy
 	* FORMAT_R8 (8-bit float) -> way smaller size, and accuracy drop MIGHT be worth it
 	*/
-	if (height_map.is_null()) {
+	if (height_map.is_null() || height_map->get_width() != WorldData::H_RESOLUTION) {
 		height_map.instantiate(WorldData::H_RESOLUTION, WorldData::H_RESOLUTION, false, Image::Format::FORMAT_RF);
 	}
+}
+
+/*
+* run the height source at coordiantes, and set in heightmap
+* one row segment per call -> sources amortize lookups (DEM tiles) over the whole segment
+*/
+void HeightMapData::generate_rect(int i_begin, int i_end, int j_begin, int j_end) {
+	const int width = height_map->get_width();
+	const real_t x = local_to_global_x(i_begin);
+	for (int j = j_begin; j < j_end; j++) {
+		const real_t z = local_to_global_z(j);
+		float *row = pixels + j * width;
+		source->sample_row(x, z, WorldData::STEP_SIZE, i_end - i_begin, row + i_begin);
+	}
+}
+
+/*
+* node pixels are sampled, everything between them is bilinear
+* nodes just past the rect belong to the next tile -> sampled again here instead of shared
+*/
+void HeightMapData::generate_rect_coarse(int i_begin, int i_end, int j_begin, int j_end) {
+	TERRAIN_TRACE_SCOPE("generate_rect_coarse");
+	const int width = height_map->get_width();
+	const int ni_begin = i_begin / REFINE_STRIDE;
+	const int nj_begin = j_begin / REFINE_STRIDE;
+	const int nodes_x = (i_end - 1) / REFINE_STRIDE + 2 - ni_begin;
+	const int nodes_z = (j_end - 1) / REFINE_STRIDE + 2 - nj_begin;
+
+	LocalVector<float> nodes;
+	nodes.resize(nodes_x * nodes_z);
+	for (int m = 0; m < nodes_z; m++) {
+		const real_t z = local_to_global_z(node_pixel(nj_begin + m));
+		for (int n = 0; n < nodes_x; n++) {
+			nodes[m * nodes_x + n] = source->sample(local_to_global_x(node_pixel(ni_begin + n)), z);
+		}
+	}
+
+	for (int j = j_begin; j < j_end; j++) {
+		const int m = j / REFINE_STRIDE - nj_begin;
+		const int z0 = node_pixel(nj_begin + m);
+		const int z1 = node_pixel(nj_begin + m + 1);
+		const real_t tz = z1 > z0 ? real_t(j - z0) / (z1 - z0) : 0.0;
+		float *row = pixels + j * width;
 
-	int j_start = 0;
-	int j_last = 0;
-	const int split = 128;
-	const int subdiv = subdivide_d + 2;
-	
-	// NUMBER OF TASKS REQUIRED TO GENERATE HEIGHT MAP
-	active_task_count.store(Math::division_round_up(subdiv,split), std::memory_order_acquire);
-
-	for (int j_size = subdiv; j_size > 0; j_size -= split) {
-		// if resolution is less than the split size, there's no point in pushing task into another thread
-		if ((j_size - split) <= 0) {
-			j_last += j_size;
-			generate_height_map(j_start, j_last);
-			return;
+		for (int i = i_begin; i < i_end; i++) {
+			const int n = i / REFINE_STRIDE - ni_begin;
+			const int x0 = node_pixel(ni_begin + n);
+			const int x1 = node_pixel(ni_begin + n + 1);
+			const real_t tx = x1 > x0 ? real_t(i - x0) / (x1 - x0) : 0.0;
+			const float *top = nodes.ptr() + m * nodes_x + n;
+			const float *bottom = top + nodes_x;
+			const real_t h0 = Math::lerp(top[0], top[1], tx);
+			const real_t h1 = Math::lerp(bottom[0], bottom[1], tx);
+			row[i] = Math::lerp(h0, h1, tz);
 		}
-		j_last += split;
-		sub_task_ids.insert(
-			WorkerThreadPool::get_singleton()->add_task_bind(
-				callable_mp(this, &HeightMapData::generate_height_map).bind(j_start,j_last), true
-			)
-		);
-		j_start = j_last;
 	}
 }
 
 /*
-* run FastNoiseLite at coordiantes, and set in heightmap
+* CALLED FROM : group task element (worker threads)
+* every pixel the coarse pass interpolated is sampled into refine_map -> node pixels are already exact
 */
-void HeightMapData::generate_height_map(int j_begin, int j_end) {
+void HeightMapData::refine_rect(int i_begin, int i_end, int j_begin, int j_end) {
+	TERRAIN_TRACE_SCOPE("refine_rect");
+	const int width = refine_map->get_width();
 	for (int j = j_begin; j < j_end; j++) {
 		const real_t z = local_to_global_z(j);
-
-		for (int i = 0; i <= (subdivide_w + 1); i++) {
-			const real_t x = local_to_global_x(i);
-			// FastNoiseLite -> computationally expensive, do before mutex
-			/*
-			float e = 
-				1.0 * noise->get_noise_2d(1 * x, 1 * z) + 
-				0.5 * noise->get_noise_2d(2 * x, 2 * z) + 
-				0.25 * noise->get_noise_2d(4 * x, 4 * z);
-			e /= (1.0 + 0.5 + 0.25);
-			e = Math::pow(e, 2.0f);
-			float r = e;
-			*/
-			float r = generate_normalized_height(x, z);
-
-			MutexLock mutex_lock(height_map_mutex);
-			height_map->set_pixel(i, j, Color(r, 0, 0));
+		float *row = refine_pixels + j * width;
+		if (!is_node_pixel(j)) {
+			source->sample_row(local_to_global_x(i_begin), z, WorldData::STEP_SIZE, i_end - i_begin, row + i_begin);
+			continue;
+		}
+		// node rows -> runs of interpolated pixels between the nodes
+		int i = i_begin;
+		while (i < i_end) {
+			if (is_node_pixel(i)) {
+				i++;
+				continue;
+			}
+			int run_end = i + 1;
+			while (run_end < i_end && !is_node_pixel(run_end)) {
+				run_end++;
+			}
+			source->sample_row(local_to_global_x(i), z, WorldData::STEP_SIZE, run_end - i, row + i);
+			i = run_end;
 		}
 	}
+}
+
+/*
+* CALLED FROM : group task element (worker threads)
+* last finished tile of a chunk runs post generation
+*/
+void HeightMapData::generate_tile(int tile_index) {
+	TERRAIN_TRACE_SCOPE("generate_tile");
+	const int tiles_per_side = get_tiles_per_side();
+	const int resolution = subdivide_w + 2;
+	const int i_begin = (tile_index % tiles_per_side) * WorldData::TILE_SIZE;
+	const int j_begin = (tile_index / tiles_per_side) * WorldData::TILE_SIZE;
+
+	const int i_end = MIN(i_begin + WorldData::TILE_SIZE, resolution);
+	const int j_end = MIN(j_begin + WorldData::TILE_SIZE, resolution);
+	switch (stage) {
+		case STAGE_COARSE:
+			generate_rect_coarse(i_begin, i_end, j_begin, j_end);
+			break;
+		case STAGE_REFINE:
+			refine_rect(i_begin, i_end, j_begin, j_end);
+			break;
+		default:
+			generate_rect(i_begin, i_end, j_begin, j_end);
+			break;
+	}
+
 	// atomically check if active_task_count > 0
 	if (active_task_count.fetch_sub(1,std::memory_order_acq_rel) > 1) return;
 
-	// multi-threaded tasks done, call_deferred so that task is called on main thread 
-	post_generation && post_generation->is_valid() ?
-		post_generation->call_deferred() :
+	// exact node pixels are kept -> refinement only fills in the interpolated ones (before any deformation is composed)
+	if (stage == STAGE_COARSE) {
+		memcpy(refine_pixels, pixels, resolution * resolution * sizeof(float));
+	}
+
+	// multi-threaded tasks done, post generation runs on this worker -> main thread work is deferred by the callee
+	if (post_generation && post_generation->is_valid()) {
+		post_generation->call();
+	} else {
 		DEBUG_PRINT_ERROR("add_chunk TASK IS INVALID");
+	}
 
 	post_generation.reset();
 }
 
 void HeightMapData::_bind_methods() {
+}
+
+
+/*
+* one candidate per global grid cell -> a cell belongs to the chunk that contains its corner
+* jitter, rotation and scale come from hashing the cell, so re-generated chunks scatter identically
+*/
+void ScatterData::generate(HeightMapData *hmap_data) {
+	TERRAIN_TRACE_SCOPE("ScatterData::generate");
+	const int cells = get_cells_per_side();
+	instance_buffer.resize(cells * cells * FLOATS_PER_INSTANCE);
+	float *buffer = instance_buffer.ptrw();
+	instance_count = 0;
+
+	const Vector3 start = hmap_data->get_start_pos();
+	const Vector3 end = hmap_data->get_end_pos();
+	const int cell_x_begin = Math::ceil(start.x / WorldData::SCATTER_SPACING);
+	const int cell_z_begin = Math::ceil(start.z / WorldData::SCATTER_SPACING);
+	const real_t step = WorldData::STEP_SIZE;
+	const Ref<Image> &map = hmap_data->get_generated_image();
+	scattered = true;
+
+	for (int cz = cell_z_begin; cz < cell_z_begin + cells; cz++) {
+		for (int cx = cell_x_begin; cx < cell_x_begin + cells; cx++) {
+			const Vector3 corner = Vector3(cx, 0, cz) * WorldData::SCATTER_SPACING;
+			if (!hmap_data->in_bounds(corner) || cell_random(cx, cz, 0) > WorldData::SCATTER_DENSITY) {
+				continue;
+			}
+			// jitter stays inside the chunk -> cells at the +x/+z edges would otherwise read clamped pixels
+			const real_t x = corner.x + cell_random(cx, cz, 1) * MIN(WorldData::SCATTER_SPACING, end.x - corner.x);
+			const real_t z = corner.z + cell_random(cx, cz, 2) * MIN(WorldData::SCATTER_SPACING, end.z - corner.z);
+
+			const int i = CLAMP(hmap_data->global_to_local_x(x), 1, WorldData::H_RESOLUTION - 2);
+			const int j = CLAMP(hmap_data->global_to_local_z(z), 1, WorldData::H_RESOLUTION - 2);
+			const real_t height = hmap_data->sample_height(map, Vector3(x, 0, z));
+			if (height < WorldData::SCATTER_MIN_HEIGHT || height > WorldData::SCATTER_MAX_HEIGHT) {
+				continue;
+			}
+			// central differences -> padding pixels keep this valid at chunk edges
+			const real_t dx = HeightMapData::get_height_local(map, i + 1, j) - HeightMapData::get_height_local(map, i - 1, j);
+			const real_t dz = HeightMapData::get_height_local(map, i, j + 1) - HeightMapData::get_height_local(map, i, j - 1);
+			if (Vector2(dx, dz).length() / (2.0 * step) > WorldData::SCATTER_MAX_SLOPE) {
+				continue;
+			}
+
+			const real_t scale = Math::lerp(WorldData::SCATTER_MIN_SCALE, WorldData::SCATTER_MAX_SCALE, cell_random(cx, cz, 3));
+			Basis basis = Basis(Vector3(0, 1, 0), cell_random(cx, cz, 4) * Math::TAU).scaled(Vector3(scale, scale, scale));
+
+			float *t = buffer + instance_count * FLOATS_PER_INSTANCE;
+			t[0] = basis.rows[0][0]; t[1] = basis.rows[0][1]; t[2] = basis.rows[0][2]; t[3] = x;
+			t[4] = basis.rows[1][0]; t[5] = basis.rows[1][1]; t[6] = basis.rows[1][2]; t[7] = height;
+			t[8] = basis.rows[2][0]; t[9] = basis.rows[2][1]; t[10] = basis.rows[2][2]; t[11] = z;
+			instance_count++;
+		}
+	}
+}
+
+/*
+* single buffer upload -> no per-instance work on the main thread
+* multimesh is only re-allocated when the candidate count changes (SCATTER_SPACING)
+*/
+void ScatterData::update() {
+	TERRAIN_TRACE_SCOPE("ScatterData::update");
+	if (!WorldData::SCATTER_MESH.is_valid()) {
+		set_visiblity(false);
+		return;
+	}
+	const int capacity = instance_buffer.size() / FLOATS_PER_INSTANCE;
+	if (allocated_count != capacity) {
+		RS::get_singleton()->multimesh_allocate_data(multimesh_rid, capacity, RS::MULTIMESH_TRANSFORM_3D);
+		allocated_count = capacity;
+	}
+	RS::get_singleton()->multimesh_set_mesh(multimesh_rid, WorldData::SCATTER_MESH);
+	RS::get_singleton()->multimesh_set_buffer(multimesh_rid, instance_buffer);
+	RS::get_singleton()->multimesh_set_visible_instances(multimesh_rid, instance_count);
+	set_visiblity(instance_count > 0);
+}
+
+/*
+* same layout as PlaneMesh (FACE_Y) -> vertices, uvs, winding and tangents match what the shader was written for
+*/
+Array MeshData::create_plane_arrays(int p_subdivisions) {
+	const int side = p_subdivisions + 2;
+	const real_t length = WorldData::LENGTH;
+	const real_t step = length / (p_subdivisions + 1.0);
+
+	PackedVector3Array points;
+	PackedVector3Array normals;
+	PackedFloat32Array tangents;
+	PackedVector2Array uvs;
+	PackedInt32Array indices;
+	points.resize(side * side);
+	normals.resize(side * side);
+	tangents.resize(side * side * 4);
+	uvs.resize(side * side);
+	indices.resize((side - 1) * (side - 1) * 6);
+
+	Vector3 *p = points.ptrw();
+	Vector3 *n = normals.ptrw();
+	float *t = tangents.ptrw();
+	Vector2 *uv = uvs.ptrw();
+	int32_t *idx = indices.ptrw();
+	int point = 0;
+	int index = 0;
+	for (int j = 0; j < side; j++) {
+		const real_t z = -0.5 * length + j * step;
+		for (int i = 0; i < side; i++) {
+			const real_t x = -0.5 * length + i * step;
+			p[point] = Vector3(-x, 0.0, -z);
+			n[point] = Vector3(0.0, 1.0, 0.0);
+			t[point * 4 + 0] = 1.0; t[point * 4 + 1] = 0.0; t[point * 4 + 2] = 0.0; t[point * 4 + 3] = 1.0;
+			uv[point] = Vector2(1.0 - i / (side - 1.0), 1.0 - j / (side - 1.0));
+
+			if (i > 0 && j > 0) {
+				const int prevrow = (j - 1) * side;
+				const int thisrow = j * side;
+				idx[index++] = prevrow + i - 1;
+				idx[index++] = prevrow + i;
+				idx[index++] = thisrow + i - 1;
+				idx[index++] = prevrow + i;
+				idx[index++] = thisrow + i;
+				idx[index++] = thisrow + i - 1;
+			}
+			point++;
+		}
+	}
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = points;
+	arrays[Mesh::ARRAY_NORMAL] = normals;
+	arrays[Mesh::ARRAY_TANGENT] = tangents;
+	arrays[Mesh::ARRAY_TEX_UV] = uvs;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+	return arrays;
+}
+
+/*
+* CALLED FROM : prepare_lod_meshes() (group task element)
+* p_arrays -> one slot per missing lod, subdivision count is stored in the slot beforehand
+*/
+void MeshData::build_plane_arrays(void *p_arrays, uint32_t p_index) {
+	TERRAIN_TRACE_SCOPE("MeshData::build_plane_arrays");
+	Array &slot = static_cast<LocalVector<Array> *>(p_arrays)->operator[](p_index);
+	slot = create_plane_arrays(slot[0]);
+}
+
+/*
+* CALLED FROM : TerrainGenerator::build_lod_ring()
+* arrays in parallel on workers, mesh upload on the main thread -> a handful of meshes instead of one per slot
+*/
+void MeshData::prepare_lod_meshes(const HashSet<int> &p_lods) {
+	const Vector2 key(WorldData::LENGTH, WorldData::STEP_SIZE);
+	if (lod_mesh_cache_key != key) {
+		lod_mesh_cache.clear();
+		lod_mesh_cache_key = key;
+	}
+	LocalVector<int> missing;
+	LocalVector<Array> arrays;
+	for (int lod : p_lods) {
+		if (lod_mesh_cache.has(lod)) {
+			continue;
+		}
+		missing.push_back(lod);
+		Array slot;
+		slot.push_back(int(WorldData::LENGTH / (WorldData::STEP_SIZE * (1 << lod))) - 1);
+		arrays.push_back(slot);
+	}
+	if (missing.is_empty()) {
+		return;
+	}
+	WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_native_group_task(
+		&MeshData::build_plane_arrays, &arrays, missing.size(), -1, true, "TerrainGenerator lod meshes"
+	);
+	WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+
+	for (uint32_t i = 0; i < missing.size(); i++) {
+		Ref<ArrayMesh> mesh;
+		mesh.instantiate();
+		mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays[i]);
+		// INF used for testing -> will use reasonable value after finalizing terrain generation design
+		set_mesh_aabb(mesh, Math::INF);
+		lod_mesh_cache[missing[i]] = mesh;
+	}
+	DEBUG_PRINT_RARE("LOD MESHES BUILT", missing.size());
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 // For multi-threading
 #include "custom_types/helper_types.h"
+#include "height_source.h"
 
 #include <optional>
 
@@ -9,6 +10,8 @@ class WorldData {
 public:
     static RID world_scenario;
     static Ref<Shader> terrain_shader;
+    // null -> NoiseHeightSource with the parameters below (HeightSource::get_active)
+    static Ref<HeightSource> height_source;
     
     static int SEED;
     /*
@@ -28,6 +31,8 @@ public:
     static real_t AMPLITUDE;
     static real_t LOD_LIMIT;
     static int H_RESOLUTION;
+    // side length (pixels) of one generation tile -> auto-tuned from H_RESOLUTION and worker count
+    static int TILE_SIZE;
     // Y ONLY OFFSET -> XZ NOT ACCOUNTED FOR CURRENTLY
     static Vector3 WORLD_OFFSET;
 
@@ -40,13 +45,87 @@ public:
     static real_t FRACTAL_LACUNARITY;
     // reduces strength of successive octaves
     static real_t FRACTAL_GAIN;
+
+    // VEGETATION SCATTER -> disabled while SCATTER_MESH is invalid
+    static RID SCATTER_MESH;
+    // world units between candidate positions (one candidate per grid cell)
+    static real_t SCATTER_SPACING;
+    // chance [0,1] that a candidate is kept
+    static real_t SCATTER_DENSITY;
+    // true height band that allows instances
+    static real_t SCATTER_MIN_HEIGHT;
+    static real_t SCATTER_MAX_HEIGHT;
+    // maximum rise over run
+    static real_t SCATTER_MAX_SLOPE;
+    // random uniform scale range
+    static real_t SCATTER_MIN_SCALE;
+    static real_t SCATTER_MAX_SCALE;
+};
+
+
+class HeightMapData;
+
+/*
+* per chunk MultiMesh -> recycled together with its HeightMapData
+* instance transforms are computed on worker threads, main thread only uploads the finished buffer
+*/
+class ScatterData : public RefCounted {
+	GDCLASS(ScatterData, RefCounted);
+
+    RID multimesh_rid;
+    RID instance_rid;
+    // MULTIMESH_TRANSFORM_3D -> 12 floats per instance, sized to the candidate count so allocations are reused
+    Vector<float> instance_buffer;
+    int instance_count = 0;
+    int allocated_count = 0;
+    // false until generate() ran for the current chunk position
+    bool scattered = false;
+
+public:
+    static constexpr int FLOATS_PER_INSTANCE = 12;
+
+    // candidate cells along one side of a chunk
+    static int get_cells_per_side() { return MAX(1, int(Math::ceil(WorldData::LENGTH / WorldData::SCATTER_SPACING))); }
+    // deterministic [0,1] random per global cell -> same trees every time a chunk is generated
+    static real_t cell_random(int cell_x, int cell_z, uint32_t channel) {
+        uint32_t h = hash_murmur3_one_32(cell_x, hash_murmur3_one_32(cell_z, WorldData::SEED));
+        h = hash_fmix32(h + channel * 0x9E3779B9);
+        return real_t(h & 0xFFFFFF) / real_t(0xFFFFFF);
+    }
+
+    // Only for worker threads
+    void generate(HeightMapData *hmap_data);
+    // chunk finished without scattering -> transforms from its previous position are never uploaded
+    void clear() {
+        instance_count = 0;
+        scattered = false;
+    }
+    // Only for main thread
+    void update();
+
+    int get_instance_count() const { return instance_count; }
+    bool is_scattered() const { return scattered; }
+    void set_visiblity(bool p_visible) { RS::get_singleton()->instance_set_visible(instance_rid, p_visible); }
+
+    ScatterData() {
+        multimesh_rid = RS::get_singleton()->multimesh_create();
+        instance_rid = RS::get_singleton()->instance_create();
+        RS::get_singleton()->instance_set_scenario(instance_rid, WorldData::world_scenario);
+        RS::get_singleton()->instance_set_base(instance_rid, multimesh_rid);
+        set_visiblity(false);
+    }
+    ~ScatterData() {
+        RS::get_singleton()->free(instance_rid);
+        RS::get_singleton()->free(multimesh_rid);
+    }
 };
 
 
 class HeightMapData : public RefCounted {
 	GDCLASS(HeightMapData, RefCounted);
 
-    Ref<FastNoiseLite> noise;
+    // captured when generation starts -> swapping WorldData::height_source never affects running tiles
+    Ref<HeightSource> source;
     Ref<Image> height_map;
     Vector3 world_position;
     Vector3 start_pos;
@@ -54,66 +133,165 @@ class HeightMapData : public RefCounted {
     int subdivide_w;
     int subdivide_d;
 
-	Mutex height_map_mutex;
+    // written by tiles without locking -> tiles never overlap, pointer is taken once on the main thread
+    float *pixels = nullptr;
     std::atomic_int active_task_count = 0;
-    HashSet<u_int64_t> sub_task_ids;
     std::unique_ptr<Callable> post_generation;
+
+    /*
+    * PROGRESSIVE REFINEMENT -> STAGE_COARSE samples every REFINE_STRIDE-th pixel and interpolates the rest
+    * the coarse result is copied into refine_map, STAGE_REFINE samples only the interpolated pixels into it
+    * apply_refinement() swaps the maps on the main thread -> the uploaded image is never written by workers
+    */
+    enum Stage {
+        STAGE_FULL,
+        STAGE_COARSE,
+        STAGE_REFINE,
+    };
+    Stage stage = STAGE_FULL;
+    // main thread only -> false while the image still holds interpolated pixels
+    bool refined = true;
+    Ref<Image> refine_map;
+    float *refine_pixels = nullptr;
+
+    // pixel index of node n along one side -> the last pixel is always a node
+    static int node_pixel(int n) { return MIN(n * REFINE_STRIDE, WorldData::H_RESOLUTION - 1); }
+    static bool is_node_pixel(int i) { return i % REFINE_STRIDE == 0 || i == WorldData::H_RESOLUTION - 1; }
+    void generate_rect_coarse(int i_begin, int i_end, int j_begin, int j_end);
+    void refine_rect(int i_begin, int i_end, int j_begin, int j_end);
+    Ref<ScatterData> scatter_data;
 public:
-    double true_height(real_t h) const {
+    // 1 in REFINE_STRIDE² pixels is sampled for the first visible version of a chunk
+    static constexpr int REFINE_STRIDE = 4;
+
+    static double true_height(real_t h) {
         return Math::pow(h * WorldData::AMPLITUDE, WorldData::HEIGHT_EXP) + WorldData::WORLD_OFFSET.y;
     }
-    float generate_normalized_height(int x, int z) const { return (noise->get_noise_2d(x,z) + 1.0) / 2.0; }
-    float get_height_local(int x, int z) const { return true_height(height_map->get_pixel(x,z).r); }   // local within image, not position
+    // heights below WORLD_OFFSET.y cannot be represented -> clamped
+    static real_t inverse_true_height(double y) {
+        return Math::pow(MAX(y - WorldData::WORLD_OFFSET.y, 0.0), 1.0 / WorldData::HEIGHT_EXP) / WorldData::AMPLITUDE;
+    }
+    // global position pixel (0,0) is drawn and collided at -> pixel p sits at world_position + (p - 1) * STEP_SIZE
+    static Vector3 chunk_start_pos(const Vector3 &chunk_pos) {
+        return chunk_pos * WorldData::LENGTH + Vector3(-0.5 * WorldData::LENGTH - WorldData::STEP_SIZE, 0, -0.5 * WorldData::LENGTH - WorldData::STEP_SIZE);
+    }
+    // world xz sampled for a chunk, padding included -> what a height source has to provide
+    static Rect2 get_sample_area(const Vector3 &chunk_pos) {
+        const Vector3 origin = chunk_pos * WorldData::LENGTH - Vector3(0.5 * WorldData::LENGTH, 0, 0.5 * WorldData::LENGTH);
+        return Rect2(origin.x, origin.z, WorldData::LENGTH + 3.0 * WorldData::STEP_SIZE, WorldData::LENGTH + 3.0 * WorldData::STEP_SIZE);
+    }
+    float generate_normalized_height(int x, int z) const { return source->sample(x, z); }
+    float get_height_local(int x, int z) const { return get_height_local(height_map, x, z); }   // local within image, not position
+    static float get_height_local(const Ref<Image> &p_map, int x, int z) { return true_height(p_map->get_pixel(x,z).r); }
 
     real_t local_to_global_x(int i) { return start_pos.x + (i * WorldData::STEP_SIZE); }
     real_t local_to_global_z(int j) { return start_pos.z + (j * WorldData::STEP_SIZE); }
+    // nearest drawn pixel for a global coordinate -> same mapping as the shader and get_height_global, clamped to the image
+    int global_to_local_x(real_t x) const { return CLAMP(int(Math::round((x - world_position.x) / WorldData::STEP_SIZE)) + 1, 0, WorldData::H_RESOLUTION - 1); }
+    int global_to_local_z(real_t z) const { return CLAMP(int(Math::round((z - world_position.z) / WorldData::STEP_SIZE)) + 1, 0, WorldData::H_RESOLUTION - 1); }
+    Vector3 get_start_pos() const { return start_pos; }
+    Vector3 get_end_pos() const { return end_pos; }
 
-    void setup_height_map(Size2 size, Vector3 position);
-    void generate_height_map(int j_begin, int j_end);
+    void set_bounds(Size2 size, Vector3 position);
+    void generate_rect(int i_begin, int i_end, int j_begin, int j_end);
+    void generate_tile(int tile_index);
+
+    // tiles along one side / per chunk -> every chunk shares the same tile layout
+    static int get_tiles_per_side() { return Math::division_round_up(WorldData::H_RESOLUTION, WorldData::TILE_SIZE); }
+    static int get_tile_count() { return get_tiles_per_side() * get_tiles_per_side(); }
 
     // for collision mapping
     float generate_height(int x, int z) const {
-        return (noise.is_valid() ? true_height(generate_normalized_height(x,z)) : 0.0);
+        return (source.is_valid() ? true_height(generate_normalized_height(x,z)) : 0.0);
     }
     Ref<Image> get_image() { 
         return height_map;
     }
+    Ref<ScatterData> get_scatter_data() const { return scatter_data; }
+    void set_scatter_data(const Ref<ScatterData> &p_scatter_data) { scatter_data = p_scatter_data; }
     float get_height_global(Vector3 global) {
         Vector3 local = (world_position - global).abs().posmod(WorldData::LENGTH + WorldData::STEP_SIZE);
         Vector3 scaled = (local / WorldData::STEP_SIZE).round() + Vector3(1,0,1);
         return get_height_local(scaled.x, scaled.z);
     }
-    bool in_bounds(Vector3 global_pos) {
+    // bilinear between the four surrounding pixels -> smooth queries between collision vertices
+    real_t sample_height(const Vector3 &global) const { return sample_height(height_map, global); }
+    real_t sample_height(const Ref<Image> &p_map, const Vector3 &global) const {
+        const real_t fx = (global.x - world_position.x) / WorldData::STEP_SIZE + 1.0;
+        const real_t fz = (global.z - world_position.z) / WorldData::STEP_SIZE + 1.0;
+        const int i = CLAMP(int(Math::floor(fx)), 0, WorldData::H_RESOLUTION - 2);
+        const int j = CLAMP(int(Math::floor(fz)), 0, WorldData::H_RESOLUTION - 2);
+        const real_t tx = CLAMP(fx - i, 0.0, 1.0);
+        const real_t tz = CLAMP(fz - j, 0.0, 1.0);
+        const real_t h0 = Math::lerp(get_height_local(p_map, i, j), get_height_local(p_map, i + 1, j), tx);
+        const real_t h1 = Math::lerp(get_height_local(p_map, i, j + 1), get_height_local(p_map, i + 1, j + 1), tx);
+        return Math::lerp(h0, h1, tz);
+    }
+    bool in_bounds(Vector3 global_pos) const {
         const bool x_bounds = (global_pos.x >= start_pos.x) && (global_pos.x < end_pos.x);
         const bool z_bounds = (global_pos.z >= start_pos.z) && (global_pos.z < end_pos.z);
         return x_bounds && z_bounds;
     }
 
-    void update_noise_params() {
-        noise->set_noise_type(WorldData::noise_type);
-        noise->set_frequency(WorldData::NOISE_FREQUENCY);
-        
-        noise->set_fractal_type(WorldData::fractal_type);
-        noise->set_fractal_octaves(WorldData::FRACTAL_OCTAVES);
-        noise->set_fractal_lacunarity(WorldData::FRACTAL_LACUNARITY);
-        noise->set_fractal_gain(WorldData::FRACTAL_GAIN);
-        /*
-        noise->set_domain_warp_enabled(true);
-        noise->set_domain_warp_amplitude(50.0);
-        noise->set_domain_warp_frequency(0.45);
-        noise->set_domain_warp_type(FastNoiseLite::DOMAIN_WARP_SIMPLEX);
-        noise->set_domain_warp_fractal_octaves();
-        */
-    }
-
-    void _instantiate(Vector3 new_pos, Callable p_callable) {
+    /*
+    * p_coarse -> STAGE_COARSE, the chunk has to go through _instantiate_refinement() afterwards
+    * refine_map is allocated here (main thread) so the last coarse tile can copy into it
+    */
+    void _instantiate(Vector3 new_pos, Callable p_callable, bool p_coarse = false) {
         //float octave_total = 2.0 + (1.0 - (1.0 / lod));		// Partial Sum Formula (Geometric Series)
-        if (noise.is_null()) {
-            noise.instantiate();
-            update_noise_params();
-        }
+        source = HeightSource::get_active();
         post_generation = std::make_unique<Callable>(p_callable); 
-        setup_height_map(Size2(WorldData::LENGTH, WorldData::LENGTH), new_pos);
+        set_bounds(Size2(WorldData::LENGTH, WorldData::LENGTH), new_pos);
+        stage = p_coarse ? STAGE_COARSE : STAGE_FULL;
+        refined = !p_coarse;
+        if (p_coarse) {
+            if (refine_map.is_null() || refine_map->get_width() != WorldData::H_RESOLUTION) {
+                refine_map.instantiate(WorldData::H_RESOLUTION, WorldData::H_RESOLUTION, false, Image::Format::FORMAT_RF);
+            }
+            refine_pixels = reinterpret_cast<float *>(refine_map->ptrw());
+        }
+        // NUMBER OF TILES REQUIRED TO GENERATE HEIGHT MAP -> tiles are run by the caller (group task)
+        active_task_count.store(get_tile_count(), std::memory_order_release);
+        pixels = reinterpret_cast<float *>(height_map->ptrw());
+    }
+
+    // second pass over the same tile layout -> only valid after a coarse pass, source and bounds are kept
+    void _instantiate_refinement(Callable p_callable) {
+        post_generation = std::make_unique<Callable>(p_callable);
+        stage = STAGE_REFINE;
+        active_task_count.store(get_tile_count(), std::memory_order_release);
+    }
+    // Only for main thread -> the refined pixels become the chunk image, deformation has to be composed again
+    // the coarse image is released -> pooled chunks only hold a second buffer while they are coarse
+    void apply_refinement() {
+        SWAP(height_map, refine_map);
+        refine_map.unref();
+        pixels = nullptr;
+        refine_pixels = nullptr;
+        stage = STAGE_FULL;
+        refined = true;
+    }
+    bool is_refined() const { return refined; }
+    // Only for worker threads -> heights the last pass wrote, refine_map until apply_refinement() swaps it in
+    const Ref<Image> &get_generated_image() const { return stage == STAGE_REFINE ? refine_map : height_map; }
+
+    // heights already exist (baked region pack) -> no noise, straight to post generation
+    void _instantiate_from_data(Vector3 new_pos, const Vector<uint8_t> &p_data, Callable p_callable) {
+        stage = STAGE_FULL;
+        refined = true;
+        set_bounds(Size2(WorldData::LENGTH, WorldData::LENGTH), new_pos);
+        height_map->set_data(WorldData::H_RESOLUTION, WorldData::H_RESOLUTION, false, Image::Format::FORMAT_RF, p_data);
+        p_callable.call();
+    }
+
+    // blocking generation on the calling thread -> only for offline baking
+    void generate_immediate(Vector3 new_pos) {
+        source = HeightSource::get_active();
+        stage = STAGE_FULL;
+        refined = true;
+        set_bounds(Size2(WorldData::LENGTH, WorldData::LENGTH), new_pos);
+        pixels = reinterpret_cast<float *>(height_map->ptrw());
+        generate_rect(0, subdivide_w + 2, 0, subdivide_d + 2);
     }
 
 	static void _bind_methods();
@@ -129,9 +307,19 @@ class MeshData : public RefCounted {
 
     RID geometry_instance_rid;
     Ref<ShaderMaterial> shader_material;
-    Ref<PlaneMesh> plane_mesh;
+    // shared by every slot of the same lod -> material is set per instance
+    Ref<ArrayMesh> lod_mesh;
 	Ref<ImageTexture> height_map_texture;
 
+    /*
+    * LOD MESH CACHE -> one plane per lod level instead of one per slot
+    * arrays are built on worker threads, meshes survive re-initialization while LENGTH/STEP_SIZE are unchanged
+    */
+    static HashMap<int, Ref<ArrayMesh>> lod_mesh_cache;
+    static Vector2 lod_mesh_cache_key;
+    static Array create_plane_arrays(int p_subdivisions);
+    static void build_plane_arrays(void *p_arrays, uint32_t p_index);
+
     Transform3D world_transform;
     Vector3 chunk_position;
 
@@ -146,6 +334,7 @@ public:
     }
 
     void update(Ref<Image> hmap_image, Vector3 new_pos) {
+        TERRAIN_TRACE_SCOPE("MeshData::update");
         if (height_map_texture.is_null()) {
             height_map_texture = ImageTexture::create_from_image(hmap_image);
             // set shader
@@ -161,6 +350,10 @@ public:
 
     Vector3 get_chunk_pos() const { return chunk_position; }
     void set_visiblity(bool p_visible) { RS::get_singleton()->instance_set_visible(geometry_instance_rid, p_visible); }
+    // render layers of the owning observer's viewport
+    void set_layer_mask(uint32_t p_layer_mask) { RS::get_singleton()->instance_set_layer_mask(geometry_instance_rid, p_layer_mask); }
+    // center of the owning observer's ring -> per material, so several rings can coexist
+    void set_clipmap_position(const Vector3 &p_position) { shader_material->set_shader_parameter("clipmap_position", p_position); }
 
     void set_shader_material() {
         if (shader_material.is_null()) {
@@ -170,38 +363,34 @@ public:
     }
 
     // controls mesh culling distances
-    void set_mesh_aabb(const real_t &aabb_factor) const {
+    static void set_mesh_aabb(const Ref<ArrayMesh> &p_mesh, const real_t &aabb_factor) {
         AABB aabb;
         aabb.grow_by(WorldData::LENGTH * aabb_factor);
-        plane_mesh->set_custom_aabb(aabb);
+        p_mesh->set_custom_aabb(aabb);
     }
 
+    // builds every missing lod plane in parallel -> call before constructing MeshData for those lods
+    static void prepare_lod_meshes(const HashSet<int> &p_lods);
+    static void clear_lod_mesh_cache() { lod_mesh_cache.clear(); }
+
     MeshData();
     MeshData(LODS lod_factor, Vector3 grid_pos) : chunk_position(grid_pos) {
         set_shader_material();
 
-        int lod = 1 << lod_factor[LODS::CENTER];
-        int subdivide_w = (WorldData::LENGTH / (WorldData::STEP_SIZE * lod)) - 1;
-        int subdivide_d = (WorldData::LENGTH / (WorldData::STEP_SIZE * lod)) - 1;
-
-        plane_mesh.instantiate();
-        plane_mesh->set_size(Size2(WorldData::LENGTH, WorldData::LENGTH));
-        plane_mesh->set_subdivide_width(subdivide_w);
-        plane_mesh->set_subdivide_depth(subdivide_d);
-        plane_mesh->surface_set_material(0, shader_material);
+        const Ref<ArrayMesh> *cached = lod_mesh_cache.getptr(lod_factor[LODS::CENTER]);
+        ERR_FAIL_NULL_MSG(cached, "LOD mesh was not prepared before creating MeshData.");
+        lod_mesh = *cached;
 
         geometry_instance_rid = RS::get_singleton()->instance_create();
 		RS::get_singleton()->instance_set_scenario(geometry_instance_rid, WorldData::world_scenario);
-	    RS::get_singleton()->instance_set_base(geometry_instance_rid, plane_mesh->get_rid());
+	    RS::get_singleton()->instance_set_base(geometry_instance_rid, lod_mesh->get_rid());
+        RS::get_singleton()->instance_geometry_set_material_override(geometry_instance_rid, shader_material->get_rid());
 
-        // INF used for testing -> will use reasonable value after finalizing terrain generation design
-        set_mesh_aabb(Math::INF);
         set_position(grid_pos);
     }
     ~MeshData() {
         if (geometry_instance_rid.is_valid()) {
             RS::get_singleton()->free(geometry_instance_rid);
         }
-        WorldData::terrain_shader.unref();
     }
 };
\ No newline at end of file
@@ -0,0 +1,528 @@
+#include "height_source.h"
+#include "height_map_data.h"
+
+#include "core/io/file_access.h"
+
+#include <png.h>
+
+void HeightSource::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("sample", "p_x", "p_z"), &HeightSource::sample);
+	ClassDB::bind_method(D_METHOD("prefetch", "p_area"), &HeightSource::prefetch);
+}
+
+Ref<HeightSource> HeightSource::get_active() {
+	if (WorldData::height_source.is_null()) {
+		WorldData::height_source = memnew(NoiseHeightSource);
+	}
+	return WorldData::height_source;
+}
+
+uint32_t HeightSource::hash_height_mapping(uint32_t p_hash) {
+	uint32_t h = hash_murmur3_one_real(WorldData::AMPLITUDE, p_hash);
+	h = hash_murmur3_one_real(WorldData::HEIGHT_EXP, h);
+	return hash_murmur3_one_real(WorldData::WORLD_OFFSET.y, h);
+}
+
+
+/*
+* NOISE
+*/
+real_t NoiseHeightSource::fractal_bound(int p_octaves) {
+	real_t amp = 1.0;
+	real_t sum = 0.0;
+	for (int i = 0; i < p_octaves; i++) {
+		sum += amp;
+		amp *= Math::abs(WorldData::FRACTAL_GAIN);
+	}
+	return sum;
+}
+
+void NoiseHeightSource::apply_noise_params(const Ref<FastNoiseLite> &p_noise, int p_octaves) {
+	p_noise->set_noise_type(WorldData::noise_type);
+	p_noise->set_frequency(WorldData::NOISE_FREQUENCY);
+
+	p_noise->set_fractal_type(WorldData::fractal_type);
+	p_noise->set_fractal_octaves(p_octaves);
+	p_noise->set_fractal_lacunarity(WorldData::FRACTAL_LACUNARITY);
+	p_noise->set_fractal_gain(WorldData::FRACTAL_GAIN);
+	/*
+	noise->set_domain_warp_enabled(true);
+	noise->set_domain_warp_amplitude(50.0);
+	noise->set_domain_warp_frequency(0.45);
+	noise->set_domain_warp_type(FastNoiseLite::DOMAIN_WARP_SIMPLEX);
+	noise->set_domain_warp_fractal_octaves();
+	*/
+}
+
+void NoiseHeightSource::prepare() {
+	const int full = WorldData::FRACTAL_OCTAVES;
+	const int used = octaves > 0 ? MIN(octaves, full) : full;
+	apply_noise_params(noise, used);
+	octave_scale = fractal_bound(used) / fractal_bound(full);
+}
+
+Ref<HeightSource> NoiseHeightSource::create_coarse(int p_octaves, real_t p_spacing) {
+	Ref<NoiseHeightSource> coarse;
+	coarse.instantiate();
+	coarse->set_octaves(octaves > 0 ? MIN(octaves, p_octaves) : p_octaves);
+	coarse->prepare();
+	return coarse;
+}
+
+uint32_t NoiseHeightSource::get_config_hash() const {
+	uint32_t h = hash_murmur3_one_32(WorldData::SEED);
+	h = hash_murmur3_one_32(WorldData::noise_type, h);
+	h = hash_murmur3_one_32(WorldData::fractal_type, h);
+	h = hash_murmur3_one_real(WorldData::NOISE_FREQUENCY, h);
+	h = hash_murmur3_one_real(WorldData::FRACTAL_OCTAVES, h);
+	h = hash_murmur3_one_real(WorldData::FRACTAL_LACUNARITY, h);
+	h = hash_murmur3_one_real(WorldData::FRACTAL_GAIN, h);
+	h = hash_murmur3_one_32(octaves, h);
+	return hash_fmix32(h);
+}
+
+void NoiseHeightSource::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_octaves", "p_octaves"), &NoiseHeightSource::set_octaves);
+	ClassDB::bind_method(D_METHOD("get_octaves"), &NoiseHeightSource::get_octaves);
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "octaves"), "set_octaves", "get_octaves");
+}
+
+
+/*
+* DEM TILES
+*/
+void DEMHeightSource::update_config() {
+	std::shared_ptr<Config> next = std::make_shared<Config>();
+	next->directory = directory;
+	next->format = format;
+	// overview pixels have to tile the files exactly -> full resolution otherwise
+	const int d = tile_resolution % decimation == 0 ? decimation : 1;
+	next->file_resolution = tile_resolution;
+	next->decimation = d;
+	next->tile_resolution = tile_resolution / d;
+	next->origin = origin;
+	next->pixel_size = pixel_size * d;
+	next->min_elevation = min_elevation;
+	next->max_elevation = max_elevation;
+	{
+		MutexLock lock(cache_mutex);
+		config = next;
+		tiles.clear();
+	}
+}
+
+std::shared_ptr<const DEMHeightSource::Config> DEMHeightSource::get_config() const {
+	MutexLock lock(cache_mutex);
+	return config;
+}
+
+String DEMHeightSource::get_tile_path(const Config &p_config, const Vector2i &p_coord) {
+	static const char *extensions[] = { "r16", "r32", "png" };
+	return p_config.directory.path_join(vformat("%d_%d.%s", p_coord.x, p_coord.y, extensions[p_config.format]));
+}
+
+/*
+* CALLED FROM : get_tile() (worker threads, no lock held)
+* missing or malformed tiles come back empty -> cached as well, so they are not read again every sample
+* decimated configs keep every n-th pixel -> raw formats only read the rows they keep
+*/
+std::shared_ptr<DEMHeightSource::Tile> DEMHeightSource::read_tile(const Config &p_config, const Vector2i &p_coord) {
+	TERRAIN_TRACE_SCOPE("DEMHeightSource::read_tile");
+	std::shared_ptr<Tile> tile = std::make_shared<Tile>();
+	const String path = get_tile_path(p_config, p_coord);
+	if (!FileAccess::exists(path)) {
+		return tile;
+	}
+	const int file_resolution = p_config.file_resolution;
+	const int decimation = p_config.decimation;
+	const int tile_resolution = p_config.tile_resolution;
+	const real_t min_elevation = p_config.min_elevation;
+	const real_t range = p_config.max_elevation - p_config.min_elevation;
+
+	switch (p_config.format) {
+		case TILE_FORMAT_R16:
+		case TILE_FORMAT_RF: {
+			const int pixel_bytes = p_config.format == TILE_FORMAT_R16 ? 2 : 4;
+			Ref<FileAccess> f = FileAccess::open(path, FileAccess::READ);
+			ERR_FAIL_COND_V_MSG(f.is_null(), tile, "Cannot open DEM tile: " + path);
+			ERR_FAIL_COND_V_MSG(f->get_length() != uint64_t(file_resolution) * file_resolution * pixel_bytes, tile, "DEM tile has the wrong size: " + path);
+			LocalVector<uint8_t> row;
+			row.resize(file_resolution * pixel_bytes);
+			tile->elevation.resize(tile_resolution * tile_resolution);
+			for (int j = 0; j < tile_resolution; j++) {
+				f->seek(uint64_t(j) * decimation * file_resolution * pixel_bytes);
+				if (f->get_buffer(row.ptr(), row.size()) != row.size()) {
+					tile->elevation.clear();
+					ERR_FAIL_V_MSG(tile, "DEM tile is truncated: " + path);
+				}
+				for (int i = 0; i < tile_resolution; i++) {
+					const uint8_t *src = row.ptr() + i * decimation * pixel_bytes;
+					if (pixel_bytes == 2) {
+						const uint16_t v = src[0] | (src[1] << 8);
+						tile->elevation[j * tile_resolution + i] = min_elevation + range * (v / 65535.0);
+					}
+					else {
+						memcpy(&tile->elevation[j * tile_resolution + i], src, 4);
+					}
+				}
+			}
+		} break;
+		case TILE_FORMAT_PNG: {
+			const Vector<uint8_t> bytes = FileAccess::get_file_as_bytes(path);
+			// Image would strip 16-bit pngs to 8 bits -> decoded with libpng directly
+			png_image image;
+			memset(&image, 0, sizeof(image));
+			image.version = PNG_IMAGE_VERSION;
+			ERR_FAIL_COND_V_MSG(!png_image_begin_read_from_memory(&image, bytes.ptr(), bytes.size()), tile, "Cannot decode DEM tile: " + path);
+			if (int(image.width) != file_resolution || int(image.height) != file_resolution) {
+				png_image_free(&image);
+				ERR_FAIL_V_MSG(tile, "DEM tile has the wrong size: " + path);
+			}
+			// 16-bit files are read as linear gray, 8-bit files as plain gray -> no gamma conversion either way
+			const bool wide = image.format & PNG_FORMAT_FLAG_LINEAR;
+			image.format = wide ? PNG_FORMAT_LINEAR_Y : PNG_FORMAT_GRAY;
+			LocalVector<uint8_t> decoded;
+			decoded.resize(PNG_IMAGE_SIZE(image));
+			if (!png_image_finish_read(&image, nullptr, decoded.ptr(), 0, nullptr)) {
+				png_image_free(&image);
+				ERR_FAIL_V_MSG(tile, "Cannot decode DEM tile: " + path);
+			}
+			tile->elevation.resize(tile_resolution * tile_resolution);
+			const uint16_t *src16 = reinterpret_cast<const uint16_t *>(decoded.ptr());
+			for (int j = 0; j < tile_resolution; j++) {
+				for (int i = 0; i < tile_resolution; i++) {
+					const int src = (j * file_resolution + i) * decimation;
+					const real_t v = wide ? src16[src] / 65535.0 : decoded[src] / 255.0;
+					tile->elevation[j * tile_resolution + i] = min_elevation + range * v;
+				}
+			}
+		} break;
+	}
+	return tile;
+}
+
+/*
+* CALLED FROM : worker threads
+* least recently used tiles are evicted past cache_size -> tiles still held by a sampling loop stay valid
+* reads made with an outdated config are returned to their caller but not cached
+*/
+std::shared_ptr<DEMHeightSource::Tile> DEMHeightSource::get_tile(const std::shared_ptr<const Config> &p_config, const Vector2i &p_coord) const {
+	{
+		MutexLock lock(cache_mutex);
+		while (config == p_config) {
+			std::shared_ptr<Tile> *cached = tiles.getptr(p_coord);
+			if (cached != nullptr) {
+				(*cached)->last_used = ++use_tick;
+				return *cached;
+			}
+			if (!reading.has(p_coord)) {
+				break;
+			}
+			tile_read.wait(lock);
+		}
+		reading.insert(p_coord);
+	}
+
+	std::shared_ptr<Tile> tile = read_tile(*p_config, p_coord);
+	{
+		MutexLock lock(cache_mutex);
+		reading.erase(p_coord);
+		if (config == p_config) {
+			tile->last_used = ++use_tick;
+			tiles[p_coord] = tile;
+		}
+		while (int(tiles.size()) > cache_size) {
+			Vector2i oldest;
+			uint64_t oldest_tick = UINT64_MAX;
+			for (const KeyValue<Vector2i, std::shared_ptr<Tile>> &t : tiles) {
+				if (t.value->last_used < oldest_tick) {
+					oldest_tick = t.value->last_used;
+					oldest = t.key;
+				}
+			}
+			tiles.erase(oldest);
+		}
+	}
+	tile_read.notify_all();
+	return tile;
+}
+
+real_t DEMHeightSource::get_elevation(const std::shared_ptr<const Config> &p_config, int p_px, int p_pz, TileCursor &r_cursor) const {
+	const int tile_resolution = p_config->tile_resolution;
+	const Vector2i coord(Math::floor(real_t(p_px) / tile_resolution), Math::floor(real_t(p_pz) / tile_resolution));
+	if (coord != r_cursor.coord) {
+		r_cursor.tile = get_tile(p_config, coord);
+		r_cursor.coord = coord;
+	}
+	if (r_cursor.tile->elevation.is_empty()) {
+		return p_config->min_elevation;
+	}
+	const int i = p_px - coord.x * tile_resolution;
+	const int j = p_pz - coord.y * tile_resolution;
+	return r_cursor.tile->elevation[j * tile_resolution + i];
+}
+
+// bilinear between the four surrounding DEM pixels -> top/bottom cursors follow the two pixel rows
+real_t DEMHeightSource::sample_elevation(const std::shared_ptr<const Config> &p_config, real_t p_x, real_t p_z, TileCursor &r_top, TileCursor &r_bottom) const {
+	const real_t fx = (p_x - p_config->origin.x) / p_config->pixel_size;
+	const real_t fz = (p_z - p_config->origin.y) / p_config->pixel_size;
+	const int i = Math::floor(fx);
+	const int j = Math::floor(fz);
+	const real_t tx = fx - i;
+	const real_t tz = fz - j;
+	const real_t h0 = Math::lerp(get_elevation(p_config, i, j, r_top), get_elevation(p_config, i + 1, j, r_top), tx);
+	const real_t h1 = Math::lerp(get_elevation(p_config, i, j + 1, r_bottom), get_elevation(p_config, i + 1, j + 1, r_bottom), tx);
+	return Math::lerp(h0, h1, tz);
+}
+
+float DEMHeightSource::sample(real_t p_x, real_t p_z) const {
+	const std::shared_ptr<const Config> snapshot = get_config();
+	TileCursor top;
+	TileCursor bottom;
+	return HeightMapData::inverse_true_height(sample_elevation(snapshot, p_x, p_z, top, bottom));
+}
+
+// one config snapshot per row -> setters on the main thread never change a row halfway
+void DEMHeightSource::sample_row(real_t p_x, real_t p_z, real_t p_step, int p_count, float *r_heights) const {
+	const std::shared_ptr<const Config> snapshot = get_config();
+	TileCursor top;
+	TileCursor bottom;
+	for (int i = 0; i < p_count; i++) {
+		r_heights[i] = HeightMapData::inverse_true_height(sample_elevation(snapshot, p_x + i * p_step, p_z, top, bottom));
+	}
+}
+
+/*
+* CALLED FROM : dispatch_generation_batches() (main thread)
+* one low priority task per tile -> chunk generation always runs first, finished tasks are collected here
+*/
+void DEMHeightSource::prefetch(const Rect2 &p_area) {
+	for (HashMap<Vector2i, WorkerThreadPool::TaskID>::Iterator it = read_ahead_tasks.begin(); it != read_ahead_tasks.end();) {
+		if (!WorkerThreadPool::get_singleton()->is_task_completed(it->value)) {
+			++it;
+			continue;
+		}
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(it->value);
+		const Vector2i done = it->key;
+		++it;
+		read_ahead_tasks.erase(done);
+	}
+	if (directory.is_empty()) {
+		return;
+	}
+	const real_t tile_size = tile_resolution * pixel_size;
+	const Vector2i first = ((p_area.position - origin) / tile_size).floor();
+	const Vector2i last = ((p_area.get_end() - origin) / tile_size).floor();
+	for (int tz = first.y; tz <= last.y; tz++) {
+		for (int tx = first.x; tx <= last.x; tx++) {
+			const Vector2i coord(tx, tz);
+			if (read_ahead_tasks.has(coord)) {
+				continue;
+			}
+			{
+				MutexLock lock(cache_mutex);
+				if (tiles.has(coord) || reading.has(coord)) {
+					continue;
+				}
+			}
+			read_ahead_tasks[coord] = WorkerThreadPool::get_singleton()->add_template_task(
+				this, &DEMHeightSource::read_ahead, coord, false, "DEMHeightSource read ahead"
+			);
+		}
+	}
+}
+
+/*
+* overview of the same tile set with its own cache -> the horizon never evicts the tiles chunks are using
+* largest power of two decimation at or below the sample spacing that still divides the tiles into whole pixels
+*/
+Ref<HeightSource> DEMHeightSource::create_coarse(int p_octaves, real_t p_spacing) {
+	Ref<DEMHeightSource> coarse;
+	coarse.instantiate();
+	int d = 1;
+	while (d * 2 <= p_spacing / pixel_size && tile_resolution % (d * 2) == 0) {
+		d *= 2;
+	}
+	coarse->directory = directory;
+	coarse->format = format;
+	coarse->tile_resolution = tile_resolution;
+	coarse->origin = origin;
+	coarse->pixel_size = pixel_size;
+	coarse->min_elevation = min_elevation;
+	coarse->max_elevation = max_elevation;
+	coarse->decimation = d;
+	// overview tiles are d² times smaller -> the same memory holds many more of them
+	coarse->cache_size = MIN(cache_size * d * d, MAX_OVERVIEW_TILES);
+	coarse->update_config();
+	return coarse;
+}
+
+void DEMHeightSource::read_ahead(Vector2i p_coord) {
+	get_tile(get_config(), p_coord);
+}
+
+void DEMHeightSource::wait_read_ahead() {
+	for (const KeyValue<Vector2i, WorkerThreadPool::TaskID> &t : read_ahead_tasks) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(t.value);
+	}
+	read_ahead_tasks.clear();
+}
+
+uint32_t DEMHeightSource::get_config_hash() const {
+	uint32_t h = hash_murmur3_one_32(directory.hash());
+	h = hash_murmur3_one_32(format, h);
+	h = hash_murmur3_one_32(tile_resolution, h);
+	h = hash_murmur3_one_real(origin.x, h);
+	h = hash_murmur3_one_real(origin.y, h);
+	h = hash_murmur3_one_real(pixel_size, h);
+	h = hash_murmur3_one_real(min_elevation, h);
+	h = hash_murmur3_one_real(max_elevation, h);
+	return hash_fmix32(hash_height_mapping(h));
+}
+
+int DEMHeightSource::get_cached_tile_count() const {
+	MutexLock lock(cache_mutex);
+	return tiles.size();
+}
+
+void DEMHeightSource::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_directory", "p_directory"), &DEMHeightSource::set_directory);
+	ClassDB::bind_method(D_METHOD("get_directory"), &DEMHeightSource::get_directory);
+	ClassDB::bind_method(D_METHOD("set_format", "p_format"), &DEMHeightSource::set_format);
+	ClassDB::bind_method(D_METHOD("get_format"), &DEMHeightSource::get_format);
+	ClassDB::bind_method(D_METHOD("set_tile_resolution", "p_resolution"), &DEMHeightSource::set_tile_resolution);
+	ClassDB::bind_method(D_METHOD("get_tile_resolution"), &DEMHeightSource::get_tile_resolution);
+	ClassDB::bind_method(D_METHOD("set_origin", "p_origin"), &DEMHeightSource::set_origin);
+	ClassDB::bind_method(D_METHOD("get_origin"), &DEMHeightSource::get_origin);
+	ClassDB::bind_method(D_METHOD("set_pixel_size", "p_size"), &DEMHeightSource::set_pixel_size);
+	ClassDB::bind_method(D_METHOD("get_pixel_size"), &DEMHeightSource::get_pixel_size);
+	ClassDB::bind_method(D_METHOD("set_min_elevation", "p_elevation"), &DEMHeightSource::set_min_elevation);
+	ClassDB::bind_method(D_METHOD("get_min_elevation"), &DEMHeightSource::get_min_elevation);
+	ClassDB::bind_method(D_METHOD("set_max_elevation", "p_elevation"), &DEMHeightSource::set_max_elevation);
+	ClassDB::bind_method(D_METHOD("get_max_elevation"), &DEMHeightSource::get_max_elevation);
+	ClassDB::bind_method(D_METHOD("set_cache_size", "p_tiles"), &DEMHeightSource::set_cache_size);
+	ClassDB::bind_method(D_METHOD("get_cache_size"), &DEMHeightSource::get_cache_size);
+	ClassDB::bind_method(D_METHOD("get_cached_tile_count"), &DEMHeightSource::get_cached_tile_count);
+	ClassDB::bind_method(D_METHOD("wait_read_ahead"), &DEMHeightSource::wait_read_ahead);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "directory", PROPERTY_HINT_DIR), "set_directory", "get_directory");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "format", PROPERTY_HINT_ENUM, "R16,RF,PNG"), "set_format", "get_format");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_resolution"), "set_tile_resolution", "get_tile_resolution");
+	ADD_PROPERTY(PropertyInfo(Variant::VECTOR2, "origin"), "set_origin", "get_origin");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "pixel_size"), "set_pixel_size", "get_pixel_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "min_elevation"), "set_min_elevation", "get_min_elevation");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_elevation"), "set_max_elevation", "get_max_elevation");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_size"), "set_cache_size", "get_cache_size");
+
+	BIND_ENUM_CONSTANT(TILE_FORMAT_R16);
+	BIND_ENUM_CONSTANT(TILE_FORMAT_RF);
+	BIND_ENUM_CONSTANT(TILE_FORMAT_PNG);
+}
+
+
+/*
+* COMPOSITE
+*/
+float CompositeHeightSource::combine(float p_base, float p_detail) const {
+	const double height = HeightMapData::true_height(p_base) + detail_amplitude * (p_detail * 2.0 - 1.0);
+	return HeightMapData::inverse_true_height(height);
+}
+
+float CompositeHeightSource::sample(real_t p_x, real_t p_z) const {
+	const float b = base.is_valid() ? base->sample(p_x, p_z) : 0.0;
+	if (detail.is_null()) {
+		return b;
+	}
+	return combine(b, detail->sample(p_x, p_z));
+}
+
+void CompositeHeightSource::sample_row(real_t p_x, real_t p_z, real_t p_step, int p_count, float *r_heights) const {
+	if (base.is_valid()) {
+		base->sample_row(p_x, p_z, p_step, p_count, r_heights);
+	}
+	else {
+		memset(r_heights, 0, p_count * sizeof(float));
+	}
+	if (detail.is_null()) {
+		return;
+	}
+	// fixed block on the stack -> no allocation per row on workers
+	constexpr int BLOCK = 64;
+	float detail_heights[BLOCK];
+	for (int begin = 0; begin < p_count; begin += BLOCK) {
+		const int count = MIN(BLOCK, p_count - begin);
+		detail->sample_row(p_x + begin * p_step, p_z, p_step, count, detail_heights);
+		for (int i = 0; i < count; i++) {
+			r_heights[begin + i] = combine(r_heights[begin + i], detail_heights[i]);
+		}
+	}
+}
+
+void CompositeHeightSource::prepare() {
+	if (base.is_valid()) {
+		base->prepare();
+	}
+	if (detail.is_valid()) {
+		detail->prepare();
+	}
+}
+
+void CompositeHeightSource::prefetch(const Rect2 &p_area) {
+	if (base.is_valid()) {
+		base->prefetch(p_area);
+	}
+	if (detail.is_valid()) {
+		detail->prefetch(p_area);
+	}
+}
+
+void CompositeHeightSource::set_base(const Ref<HeightSource> &p_base) {
+	if (base.is_valid()) {
+		base->disconnect_changed(callable_mp((Resource *)this, &Resource::emit_changed));
+	}
+	base = p_base;
+	if (base.is_valid()) {
+		base->connect_changed(callable_mp((Resource *)this, &Resource::emit_changed));
+	}
+	emit_changed();
+}
+
+void CompositeHeightSource::set_detail(const Ref<HeightSource> &p_detail) {
+	if (detail.is_valid()) {
+		detail->disconnect_changed(callable_mp((Resource *)this, &Resource::emit_changed));
+	}
+	detail = p_detail;
+	if (detail.is_valid()) {
+		detail->connect_changed(callable_mp((Resource *)this, &Resource::emit_changed));
+	}
+	emit_changed();
+}
+
+Ref<HeightSource> CompositeHeightSource::create_coarse(int p_octaves, real_t p_spacing) {
+	Ref<CompositeHeightSource> coarse;
+	coarse.instantiate();
+	coarse->set_base(base.is_valid() ? base->create_coarse(p_octaves, p_spacing) : Ref<HeightSource>());
+	coarse->set_detail(detail.is_valid() ? detail->create_coarse(p_octaves, p_spacing) : Ref<HeightSource>());
+	coarse->set_detail_amplitude(detail_amplitude);
+	return coarse;
+}
+
+uint32_t CompositeHeightSource::get_config_hash() const {
+	uint32_t h = hash_murmur3_one_32(base.is_valid() ? base->get_config_hash() : 0);
+	h = hash_murmur3_one_32(detail.is_valid() ? detail->get_config_hash() : 0, h);
+	h = hash_murmur3_one_real(detail_amplitude, h);
+	return hash_fmix32(hash_height_mapping(h));
+}
+
+void CompositeHeightSource::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_base", "p_base"), &CompositeHeightSource::set_base);
+	ClassDB::bind_method(D_METHOD("get_base"), &CompositeHeightSource::get_base);
+	ClassDB::bind_method(D_METHOD("set_detail", "p_detail"), &CompositeHeightSource::set_detail);
+	ClassDB::bind_method(D_METHOD("get_detail"), &CompositeHeightSource::get_detail);
+	ClassDB::bind_method(D_METHOD("set_detail_amplitude", "p_amplitude"), &CompositeHeightSource::set_detail_amplitude);
+	ClassDB::bind_method(D_METHOD("get_detail_amplitude"), &CompositeHeightSource::get_detail_amplitude);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "base", PROPERTY_HINT_RESOURCE_TYPE, "HeightSource"), "set_base", "get_base");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "detail", PROPERTY_HINT_RESOURCE_TYPE, "HeightSource"), "set_detail", "get_detail");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "detail_amplitude"), "set_detail_amplitude", "get_detail_amplitude");
+}
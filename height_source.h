@@ -0,0 +1,235 @@
+#pragma once
+
+#include "custom_types/helper_types.h"
+
+#include "core/io/resource.h"
+#include "core/os/condition_variable.h"
+
+/*
+* HEIGHT SOURCE -> where HeightMapData gets its normalized heights from
+*
+* samples are normalized like the noise field ([0,1] before true_height), so amplitude/height_exp still apply
+* every sample function is called from worker threads -> implementations must be thread safe
+* the active source lives in WorldData::height_source and is captured by each chunk when generation starts
+*/
+class HeightSource : public Resource {
+	GDCLASS(HeightSource, Resource);
+
+protected:
+	static void _bind_methods();
+
+    // for sources that sample in world units -> their normalized output depends on amplitude/height_exp/offset too
+    static uint32_t hash_height_mapping(uint32_t p_hash);
+
+public:
+    // Only for worker threads
+    virtual float sample(real_t p_x, real_t p_z) const = 0;
+    // p_count samples along +x starting at (p_x, p_z) -> sources with per-sample overhead batch here
+    virtual void sample_row(real_t p_x, real_t p_z, real_t p_step, int p_count, float *r_heights) const {
+        for (int i = 0; i < p_count; i++) {
+            r_heights[i] = sample(p_x + i * p_step, p_z);
+        }
+    }
+
+    // Only for main thread
+    // called once WorldData is final (_ready, bake) -> sources that depend on it refresh here
+    virtual void prepare() {}
+    // area (world xz) that will be sampled soon -> streaming sources start reading it in the background
+    virtual void prefetch(const Rect2 &p_area) {}
+    // cheaper source for the far-field horizon -> only the first p_octaves of procedural detail
+    // p_spacing -> world units between the samples it will be asked for, streaming sources read less detail
+    virtual Ref<HeightSource> create_coarse(int p_octaves, real_t p_spacing) { return this; }
+    // everything that changes the sampled heights -> region packs baked with another config are rejected
+    virtual uint32_t get_config_hash() const { return get_class_name().hash(); }
+
+    // WorldData::height_source, or the default noise field when none was set
+    static Ref<HeightSource> get_active();
+};
+
+
+/*
+* FastNoiseLite with the WorldData noise parameters -> the original procedural terrain
+*/
+class NoiseHeightSource : public HeightSource {
+	GDCLASS(NoiseHeightSource, HeightSource);
+
+    Ref<FastNoiseLite> noise;
+    // 0 -> WorldData::FRACTAL_OCTAVES
+    int octaves = 0;
+    // fbm of fewer octaves is normalized by a smaller bound -> rescaled to match the full field
+    real_t octave_scale = 1.0;
+
+    static real_t fractal_bound(int p_octaves);
+
+protected:
+	static void _bind_methods();
+
+public:
+    float sample(real_t p_x, real_t p_z) const override { return (noise->get_noise_2d(p_x, p_z) * octave_scale + 1.0) / 2.0; }
+    void prepare() override;
+    Ref<HeightSource> create_coarse(int p_octaves, real_t p_spacing) override;
+    uint32_t get_config_hash() const override;
+
+    // same parameters as the chunks, optionally fewer octaves
+    static void apply_noise_params(const Ref<FastNoiseLite> &p_noise, int p_octaves);
+
+    void set_octaves(int p_octaves) { octaves = MAX(p_octaves, 0); emit_changed(); }
+    int get_octaves() const { return octaves; }
+
+    NoiseHeightSource() { noise.instantiate(); }
+};
+
+
+/*
+* DEM TILE SET -> grid of elevation tiles on disk, named "<tile x>_<tile z>.<ext>"
+*
+* georeferencing is given like a GeoTIFF geotransform -> origin of pixel (0,0) and world units per pixel
+* -> TILE_FORMAT_R16 : raw little endian uint16, min/max_elevation mapped to [0, 65535]
+* -> TILE_FORMAT_RF  : raw little endian float32, elevation in world units
+* -> TILE_FORMAT_PNG : 8/16-bit grayscale png, min/max_elevation mapped to the full range
+*
+* tiles are decoded into an LRU cache of cache_size tiles -> memory stays bounded for any size of data set
+* prefetch() reads tiles ahead on low priority workers, generation only reads a tile itself if it was not ready yet
+* setters publish a new immutable Config -> workers sample with the snapshot they took, changes emit `changed`
+*/
+class DEMHeightSource : public HeightSource {
+	GDCLASS(DEMHeightSource, HeightSource);
+
+public:
+    enum TileFormat {
+        TILE_FORMAT_R16,
+        TILE_FORMAT_RF,
+        TILE_FORMAT_PNG,
+    };
+
+private:
+    // elevations in world units, empty for tiles that do not exist -> read as min_elevation
+    struct Tile {
+        LocalVector<float> elevation;
+        uint64_t last_used = 0;
+    };
+
+    String directory;
+    TileFormat format = TILE_FORMAT_R16;
+    int tile_resolution = 1024;
+    Vector2 origin;
+    real_t pixel_size = 1.0;
+    real_t min_elevation = 0.0;
+    real_t max_elevation = 1000.0;
+    int cache_size = 32;
+    // > 1 only for create_coarse() overviews
+    int decimation = 1;
+    static constexpr int MAX_OVERVIEW_TILES = 1024;
+
+    // what workers read -> copied from the fields above on every change, never modified afterwards
+    struct Config {
+        String directory;
+        TileFormat format = TILE_FORMAT_R16;
+        // pixels per side in the files, and as cached after keeping every decimation-th pixel
+        int file_resolution = 1024;
+        int decimation = 1;
+        int tile_resolution = 1024;
+        Vector2 origin;
+        // world units per cached pixel
+        real_t pixel_size = 1.0;
+        real_t min_elevation = 0.0;
+        real_t max_elevation = 1000.0;
+    };
+
+    // cache_mutex guards everything below -> tile pixels are read without it, a shared_ptr keeps evicted tiles alive
+    mutable BinaryMutex cache_mutex;
+    std::shared_ptr<const Config> config;
+    mutable ConditionVariable tile_read;
+    mutable HashMap<Vector2i, std::shared_ptr<Tile>> tiles;
+    // tiles being read right now -> other workers wait instead of reading twice
+    mutable HashSet<Vector2i> reading;
+    mutable uint64_t use_tick = 0;
+
+    // main thread only -> read-ahead tasks still running
+    HashMap<Vector2i, WorkerThreadPool::TaskID> read_ahead_tasks;
+
+    // last tile used by one sampling loop -> most lookups never touch the cache lock
+    struct TileCursor {
+        Vector2i coord = Vector2i(INT32_MIN, INT32_MIN);
+        std::shared_ptr<Tile> tile;
+    };
+    std::shared_ptr<Tile> get_tile(const std::shared_ptr<const Config> &p_config, const Vector2i &p_coord) const;
+    static std::shared_ptr<Tile> read_tile(const Config &p_config, const Vector2i &p_coord);
+    real_t get_elevation(const std::shared_ptr<const Config> &p_config, int p_px, int p_pz, TileCursor &r_cursor) const;
+    real_t sample_elevation(const std::shared_ptr<const Config> &p_config, real_t p_x, real_t p_z, TileCursor &r_top, TileCursor &r_bottom) const;
+    static String get_tile_path(const Config &p_config, const Vector2i &p_coord);
+    void read_ahead(Vector2i p_coord);
+    // Only for main thread -> publishes the fields as a new Config and drops the cached tiles
+    void update_config();
+    std::shared_ptr<const Config> get_config() const;
+
+protected:
+	static void _bind_methods();
+
+public:
+    float sample(real_t p_x, real_t p_z) const override;
+    void sample_row(real_t p_x, real_t p_z, real_t p_step, int p_count, float *r_heights) const override;
+    void prefetch(const Rect2 &p_area) override;
+    Ref<HeightSource> create_coarse(int p_octaves, real_t p_spacing) override;
+    uint32_t get_config_hash() const override;
+
+    int get_cached_tile_count() const;
+    // blocks until every read-ahead task is done -> before freeing the source
+    void wait_read_ahead();
+
+    void set_directory(const String &p_directory) { directory = p_directory; update_config(); emit_changed(); }
+    String get_directory() const { return directory; }
+    void set_format(TileFormat p_format) { format = p_format; update_config(); emit_changed(); }
+    TileFormat get_format() const { return format; }
+    void set_tile_resolution(int p_resolution) { tile_resolution = MAX(p_resolution, 2); update_config(); emit_changed(); }
+    int get_tile_resolution() const { return tile_resolution; }
+    void set_origin(const Vector2 &p_origin) { origin = p_origin; update_config(); emit_changed(); }
+    Vector2 get_origin() const { return origin; }
+    void set_pixel_size(real_t p_size) { pixel_size = MAX(p_size, 1e-6); update_config(); emit_changed(); }
+    real_t get_pixel_size() const { return pixel_size; }
+    void set_min_elevation(real_t p_elevation) { min_elevation = p_elevation; update_config(); emit_changed(); }
+    real_t get_min_elevation() const { return min_elevation; }
+    void set_max_elevation(real_t p_elevation) { max_elevation = p_elevation; update_config(); emit_changed(); }
+    real_t get_max_elevation() const { return max_elevation; }
+    void set_cache_size(int p_tiles) { MutexLock lock(cache_mutex); cache_size = MAX(p_tiles, 4); }
+    int get_cache_size() const { return cache_size; }
+
+    DEMHeightSource() { update_config(); }
+    ~DEMHeightSource() { wait_read_ahead(); }
+};
+
+VARIANT_ENUM_CAST(DEMHeightSource::TileFormat);
+
+
+/*
+* procedural detail over a base source -> base heights plus detail_amplitude world units of (detail * 2 - 1)
+* typically a DEMHeightSource base with a NoiseHeightSource detail, so coarse real data gets small scale relief
+*/
+class CompositeHeightSource : public HeightSource {
+	GDCLASS(CompositeHeightSource, HeightSource);
+
+    Ref<HeightSource> base;
+    Ref<HeightSource> detail;
+    real_t detail_amplitude = 4.0;
+
+    float combine(float p_base, float p_detail) const;
+
+protected:
+	static void _bind_methods();
+
+public:
+    float sample(real_t p_x, real_t p_z) const override;
+    void sample_row(real_t p_x, real_t p_z, real_t p_step, int p_count, float *r_heights) const override;
+    void prepare() override;
+    void prefetch(const Rect2 &p_area) override;
+    Ref<HeightSource> create_coarse(int p_octaves, real_t p_spacing) override;
+    uint32_t get_config_hash() const override;
+
+    // child changes are forwarded as our own `changed`
+    void set_base(const Ref<HeightSource> &p_base);
+    Ref<HeightSource> get_base() const { return base; }
+    void set_detail(const Ref<HeightSource> &p_detail);
+    Ref<HeightSource> get_detail() const { return detail; }
+    void set_detail_amplitude(real_t p_amplitude) { detail_amplitude = p_amplitude; emit_changed(); }
+    real_t get_detail_amplitude() const { return detail_amplitude; }
+};
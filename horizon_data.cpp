@@ -0,0 +1,146 @@
+#include "horizon_data.h"
+
+HorizonData::HorizonData(const Ref<Shader> &p_shader, real_t p_span, real_t p_inner_radius, int p_resolution, int p_octaves) {
+	resolution = MAX(p_resolution, 16);
+	octaves = CLAMP(p_octaves, 1, int(WorldData::FRACTAL_OCTAVES));
+	span = p_span;
+	inner_radius = p_inner_radius;
+	source = HeightSource::get_active()->create_coarse(octaves, get_texel_size());
+
+	height_map.instantiate(resolution, resolution, false, Image::Format::FORMAT_RF);
+	back_height_map.instantiate(resolution, resolution, false, Image::Format::FORMAT_RF);
+
+	shader_material.instantiate();
+	shader_material->set_shader(p_shader);
+	shader_material->set_shader_parameter("horizon_span", span);
+	shader_material->set_shader_parameter("inner_radius", inner_radius);
+	shader_material->set_shader_parameter("blend_width", WorldData::LENGTH);
+
+	// two texels per quad -> mesh vertices never fall between the texels they interpolate
+	build_ring_mesh((resolution - 1) / 2);
+
+	instance_rid = RS::get_singleton()->instance_create();
+	RS::get_singleton()->instance_set_scenario(instance_rid, WorldData::world_scenario);
+	RS::get_singleton()->instance_set_base(instance_rid, ring_mesh->get_rid());
+	RS::get_singleton()->instance_geometry_set_cast_shadows_setting(instance_rid, RS::SHADOW_CASTING_SETTING_OFF);
+	RS::get_singleton()->instance_set_visible(instance_rid, false);
+}
+
+HorizonData::~HorizonData() {
+	wait();
+	if (instance_rid.is_valid()) {
+		RS::get_singleton()->free(instance_rid);
+	}
+}
+
+/*
+* flat grid, quads fully inside the hole are skipped -> heights are displaced in horizon.gdshader
+* the hole leaves one chunk plus the refresh distance of overlap, so the ring can lag behind the player
+*/
+void HorizonData::build_ring_mesh(int p_quads) {
+	const real_t quad_size = span / p_quads;
+	const real_t half = span / 2.0;
+	const real_t hole = MAX(0.0, inner_radius - WorldData::LENGTH - get_refresh_distance());
+
+	PackedVector3Array vertices;
+	PackedInt32Array indices;
+	vertices.resize((p_quads + 1) * (p_quads + 1));
+	Vector3 *v = vertices.ptrw();
+	for (int j = 0; j <= p_quads; j++) {
+		for (int i = 0; i <= p_quads; i++) {
+			v[j * (p_quads + 1) + i] = Vector3(i * quad_size - half, 0, j * quad_size - half);
+		}
+	}
+	for (int j = 0; j < p_quads; j++) {
+		for (int i = 0; i < p_quads; i++) {
+			const int a = j * (p_quads + 1) + i;
+			const int b = a + 1;
+			const int c = a + p_quads + 1;
+			const int d = c + 1;
+			// farthest corner inside the hole -> whole quad is covered by chunks
+			const real_t far_x = MAX(Math::abs(v[a].x), Math::abs(v[b].x));
+			const real_t far_z = MAX(Math::abs(v[a].z), Math::abs(v[c].z));
+			if (Vector2(far_x, far_z).length() < hole) {
+				continue;
+			}
+			indices.push_back(a); indices.push_back(b); indices.push_back(c);
+			indices.push_back(b); indices.push_back(d); indices.push_back(c);
+		}
+	}
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = vertices;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+	ring_mesh.instantiate();
+	ring_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays);
+	ring_mesh->surface_set_material(0, shader_material);
+
+	// heights are only known in the shader
+	const real_t max_height = HeightMapData::true_height(1.0) - WorldData::WORLD_OFFSET.y;
+	ring_mesh->set_custom_aabb(AABB(Vector3(-half, -WorldData::LENGTH, -half), Vector3(span, max_height + WorldData::LENGTH, span)));
+}
+
+/*
+* CALLED FROM : _process()
+*/
+void HorizonData::update(const Vector3 &p_player_position, const Vector3 &p_ring_center) {
+	if (group_id >= 0 && WorkerThreadPool::get_singleton()->is_group_task_completed(group_id)) {
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+		group_id = -1;
+		SWAP(height_map, back_height_map);
+		center = pending_center;
+
+		if (height_map_texture.is_null()) {
+			height_map_texture = ImageTexture::create_from_image(height_map);
+			shader_material->set_shader_parameter("horizon_heightmap", height_map_texture);
+		}
+		else {
+			height_map_texture->update(height_map);
+		}
+		shader_material->set_shader_parameter("horizon_origin", center - Vector2(span, span) / 2.0);
+		Transform3D transform;
+		transform.set_origin(Vector3(center.x, 0, center.y) + WorldData::WORLD_OFFSET);
+		RS::get_singleton()->instance_set_transform(instance_rid, transform);
+		if (!has_heights) {
+			has_heights = true;
+			RS::get_singleton()->instance_set_visible(instance_rid, true);
+		}
+	}
+	shader_material->set_shader_parameter("inner_center", p_ring_center);
+
+	const Vector2 player(p_player_position.x, p_player_position.z);
+	if (group_id < 0 && (!has_heights || player.distance_to(center) > get_refresh_distance())) {
+		start_refresh(player);
+	}
+}
+
+void HorizonData::start_refresh(const Vector2 &p_center) {
+	// snapped to whole quads (two texels) -> vertices stay on the same world grid between refreshes
+	pending_center = p_center.snappedf(get_texel_size() * 2.0);
+	back_pixels = reinterpret_cast<float *>(back_height_map->ptrw());
+	const Vector2 origin = pending_center - Vector2(span, span) / 2.0;
+	// low priority -> chunk batches always run first
+	group_id = WorkerThreadPool::get_singleton()->add_template_group_task(
+		this, &HorizonData::generate_row, origin, resolution, -1, false, "TerrainGenerator horizon refresh"
+	);
+}
+
+/*
+* CALLED FROM : start_refresh() (group task element)
+* chunks draw pixel p two steps before where its height was sampled -> same shift here so both line up
+*/
+void HorizonData::generate_row(uint32_t p_row, Vector2 p_origin) {
+	TERRAIN_TRACE_SCOPE("HorizonData::generate_row");
+	const real_t texel = get_texel_size();
+	const real_t shift = 2.0 * WorldData::STEP_SIZE;
+	const real_t z = p_origin.y + p_row * texel + shift;
+	source->sample_row(p_origin.x + shift, z, texel, resolution, back_pixels + p_row * resolution);
+}
+
+void HorizonData::wait() {
+	if (group_id >= 0) {
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+		group_id = -1;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "height_map_data.h"
+
+#include "scene/resources/mesh.h"
+
+/*
+* FAR-FIELD HORIZON -> one coarse ring mesh around the chunk rings
+*
+* heights come from a low resolution heightmap of the active height source, with only a few octaves of noise
+* the heightmap is regenerated on workers (low priority) once the player drifts away from its center
+* fragments inside the chunk rings are discarded, and the inner edge is sunk below them so seams hide under real chunks
+*/
+class HorizonData : public RefCounted {
+	GDCLASS(HorizonData, RefCounted);
+
+    RID instance_rid;
+    Ref<ArrayMesh> ring_mesh;
+    Ref<ShaderMaterial> shader_material;
+    Ref<ImageTexture> height_map_texture;
+    // HeightSource::create_coarse() of the active source
+    Ref<HeightSource> source;
+
+    // front image is uploaded, back image is written by the group task
+    Ref<Image> height_map;
+    Ref<Image> back_height_map;
+    float *back_pixels = nullptr;
+    WorkerThreadPool::GroupID group_id = -1;
+
+    int resolution = 256;
+    int octaves = 3;
+    // world distance between the first and last texel along one side
+    real_t span = 0.0;
+    // inner radius of the chunk rings -> the ring mesh hole, minus slack for refreshes
+    real_t inner_radius = 0.0;
+    // world xz of the current/pending heightmap centers
+    Vector2 center;
+    Vector2 pending_center;
+    bool has_heights = false;
+
+    real_t get_texel_size() const { return span / (resolution - 1); }
+    // player distance before a refresh -> also how far the hole has to shrink to never show a gap
+    real_t get_refresh_distance() const { return span * 0.1; }
+
+    void build_ring_mesh(int p_quads);
+    void start_refresh(const Vector2 &p_center);
+
+public:
+    // Only for worker threads
+    void generate_row(uint32_t p_row, Vector2 p_origin);
+    // Only for main thread -> swaps finished heightmaps, moves the ring, schedules refreshes
+    void update(const Vector3 &p_player_position, const Vector3 &p_ring_center);
+    void set_visiblity(bool p_visible) { RS::get_singleton()->instance_set_visible(instance_rid, p_visible && has_heights); }
+    void set_layer_mask(uint32_t p_layer_mask) { RS::get_singleton()->instance_set_layer_mask(instance_rid, p_layer_mask); }
+    void set_sink_depth(real_t p_depth) { shader_material->set_shader_parameter("sink_depth", p_depth); }
+    // blocks until a running refresh is done -> before freeing or changing WorldData
+    void wait();
+
+    /*
+    * p_span -> side length of the covered square
+    * p_inner_radius -> radius fully covered by chunks around the ring center
+    */
+    HorizonData(const Ref<Shader> &p_shader, real_t p_span, real_t p_inner_radius, int p_resolution, int p_octaves);
+    HorizonData() {}
+    ~HorizonData();
+};
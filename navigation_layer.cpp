@@ -0,0 +1,239 @@
+#include "navigation_layer.h"
+
+/*
+* pixel (p_i, p_j) of the chunk image, outside of it from the neighbour that covers it
+* pixel p of the chunk is pixel p -/+ LENGTH / STEP_SIZE of its +/- neighbour -> missing neighbours repeat the edge pixel
+*/
+real_t NavigationLayer::BakeJob::height_at(int p_i, int p_j) const {
+	const int resolution = WorldData::H_RESOLUTION;
+	const int cells = WorldData::LENGTH / WorldData::STEP_SIZE;
+	const int dx = p_i < 0 ? -1 : (p_i >= resolution ? 1 : 0);
+	const int dz = p_j < 0 ? -1 : (p_j >= resolution ? 1 : 0);
+	const Vector<uint8_t> &neighbour = heights[(dz + 1) * 3 + (dx + 1)];
+	const int ni = p_i - dx * cells;
+	const int nj = p_j - dz * cells;
+	if ((dx != 0 || dz != 0) && !neighbour.is_empty() && ni >= 0 && ni < resolution && nj >= 0 && nj < resolution) {
+		return HeightMapData::true_height(reinterpret_cast<const float *>(neighbour.ptr())[nj * resolution + ni]);
+	}
+	const float *pixels = reinterpret_cast<const float *>(heights[NEIGHBOUR_CENTER].ptr());
+	return HeightMapData::true_height(pixels[CLAMP(p_j, 0, resolution - 1) * resolution + CLAMP(p_i, 0, resolution - 1)]);
+}
+
+/*
+* CALLED FROM : start_batch() (group task element)
+* vertex grid over the whole image plus job.padding pixels -> border_size of geometry around the chunk square
+*/
+void NavigationLayer::BakeBatch::bake_element(uint32_t p_index) {
+	TERRAIN_TRACE_SCOPE("NavigationLayer::bake_element");
+	BakeJob &job = jobs[p_index];
+	const int resolution = WorldData::H_RESOLUTION;
+	const real_t step = WorldData::STEP_SIZE;
+	const Vector3 start = HeightMapData::chunk_start_pos(job.chunk_pos);
+
+	LocalVector<int> samples;
+	for (int p = -job.padding; p < resolution - 1 + job.padding; p += sample_step) {
+		samples.push_back(p);
+	}
+	samples.push_back(resolution - 1 + job.padding);
+	const int side = samples.size();
+
+	LocalVector<Vector3> grid;
+	grid.resize(side * side);
+	real_t min_y = Math::INF;
+	real_t max_y = -Math::INF;
+	for (int j = 0; j < side; j++) {
+		for (int i = 0; i < side; i++) {
+			const real_t y = job.height_at(samples[i], samples[j]);
+			grid[j * side + i] = Vector3(start.x + samples[i] * step, y, start.z + samples[j] * step);
+			min_y = MIN(min_y, y);
+			max_y = MAX(max_y, y);
+		}
+	}
+
+	// clockwise seen from above -> Godot front faces, flipped for Recast by the source geometry
+	PackedVector3Array faces;
+	faces.resize((side - 1) * (side - 1) * 6);
+	Vector3 *f = faces.ptrw();
+	for (int j = 0; j < side - 1; j++) {
+		for (int i = 0; i < side - 1; i++) {
+			const Vector3 &a = grid[j * side + i];
+			const Vector3 &b = grid[j * side + i + 1];
+			const Vector3 &c = grid[(j + 1) * side + i];
+			const Vector3 &d = grid[(j + 1) * side + i + 1];
+			*f++ = a; *f++ = b; *f++ = c;
+			*f++ = b; *f++ = d; *f++ = c;
+		}
+	}
+	Ref<NavigationMeshSourceGeometryData3D> geometry;
+	geometry.instantiate();
+	geometry->add_faces(faces, Transform3D());
+
+	// clipped to the chunk square -> neighbouring tiles end on the same edge
+	const real_t half = 0.5 * WorldData::LENGTH;
+	const Vector3 center = job.chunk_pos * WorldData::LENGTH;
+	const real_t top = max_y + job.navigation_mesh->get_agent_height() + 1.0;
+	job.navigation_mesh->set_filter_baking_aabb(AABB(
+		Vector3(center.x - half, min_y - 1.0, center.z - half),
+		Vector3(WorldData::LENGTH, top - (min_y - 1.0), WorldData::LENGTH)
+	));
+	NavigationServer3D::get_singleton()->bake_from_source_geometry_data(job.navigation_mesh, geometry, Callable());
+}
+
+void NavigationLayer::set_navigation_layers(uint32_t p_layers) {
+	navigation_layers = p_layers;
+	for (const KeyValue<Vector3, Tile> &t : tiles) {
+		if (t.value.region.is_valid()) {
+			NavigationServer3D::get_singleton()->region_set_navigation_layers(t.value.region, navigation_layers);
+		}
+	}
+}
+
+void NavigationLayer::queue_bake(const HashMap<Vector3, Ref<HeightMapData>> &p_chunks, const Ref<HeightMapData> &p_hmap_data, const Vector3 &chunk_pos) {
+	Tile &tile = tiles[chunk_pos];
+	tile.version = ++last_version;
+	BakeJob *job = nullptr;
+	for (BakeJob &queued : queue) {
+		if (queued.chunk_pos == chunk_pos) {
+			job = &queued;
+			break;
+		}
+	}
+	if (job == nullptr) {
+		queue.push_back(BakeJob());
+		job = &queue[queue.size() - 1];
+		job->chunk_pos = chunk_pos;
+	}
+	job->version = tile.version;
+	// copy on write snapshots -> no pixels are copied here
+	for (int dz = -1; dz <= 1; dz++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			Vector<uint8_t> &heights = job->heights[(dz + 1) * 3 + (dx + 1)];
+			if (dx == 0 && dz == 0) {
+				heights = p_hmap_data->get_image()->get_data();
+				continue;
+			}
+			const Ref<HeightMapData> *neighbour = p_chunks.getptr(chunk_pos + Vector3(dx, 0, dz));
+			heights = neighbour != nullptr && (*neighbour)->is_refined() ? (*neighbour)->get_image()->get_data() : Vector<uint8_t>();
+		}
+	}
+}
+
+/*
+* CALLED FROM : TerrainGenerator when a chunk becomes final
+* tiles baked while this chunk was missing or coarse padded with their own edge -> re-baked with the real heights
+*/
+void NavigationLayer::queue_neighbours(const HashMap<Vector3, Ref<HeightMapData>> &p_chunks, const Vector3 &chunk_pos) {
+	if (template_mesh.is_valid() && get_padding(template_mesh) == 0) {
+		return;
+	}
+	for (int dz = -1; dz <= 1; dz++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			const Vector3 neighbour_pos = chunk_pos + Vector3(dx, 0, dz);
+			if ((dx == 0 && dz == 0) || !tiles.has(neighbour_pos)) {
+				continue;
+			}
+			const Ref<HeightMapData> *neighbour = p_chunks.getptr(neighbour_pos);
+			if (neighbour != nullptr && (*neighbour)->is_refined()) {
+				queue_bake(p_chunks, *neighbour, neighbour_pos);
+			}
+		}
+	}
+}
+
+void NavigationLayer::release(const Vector3 &chunk_pos) {
+	Tile *tile = tiles.getptr(chunk_pos);
+	if (tile == nullptr) {
+		return;
+	}
+	if (tile->region.is_valid()) {
+		NavigationServer3D::get_singleton()->free(tile->region);
+	}
+	tiles.erase(chunk_pos);
+	for (uint32_t i = 0; i < queue.size(); i++) {
+		if (queue[i].chunk_pos == chunk_pos) {
+			queue.remove_at_unordered(i);
+			break;
+		}
+	}
+}
+
+/*
+* nearest bakes first, one per worker -> the template is duplicated here since Resources are not shared between bakes
+* border_size >= agent_radius keeps Recast from eroding the tile edges, so tiles connect without gaps
+*/
+void NavigationLayer::start_batch() {
+	if (template_mesh.is_null()) {
+		template_mesh.instantiate();
+		template_mesh->set_cell_size(NavigationServer3D::get_singleton()->map_get_cell_size(map));
+		template_mesh->set_cell_height(NavigationServer3D::get_singleton()->map_get_cell_height(map));
+	}
+	const uint32_t job_limit = MAX(1, WorkerThreadPool::get_singleton()->get_thread_count());
+	const uint32_t taken = MIN(job_limit, queue.size());
+
+	BakeBatch *batch = memnew(BakeBatch);
+	batch->sample_step = sample_step;
+	for (uint32_t i = 0; i < taken; i++) {
+		BakeJob &job = queue[i];
+		job.navigation_mesh = template_mesh->duplicate();
+		job.navigation_mesh->set_border_size(MAX(job.navigation_mesh->get_border_size(), job.navigation_mesh->get_agent_radius()));
+		job.padding = get_padding(job.navigation_mesh);
+		job.navigation_mesh->set_edge_max_error(MIN(job.navigation_mesh->get_edge_max_error(), (real_t)1.0));
+		batch->jobs.push_back(job);
+	}
+	for (uint32_t i = taken; i < queue.size(); i++) {
+		queue[i - taken] = queue[i];
+	}
+	queue.resize(queue.size() - taken);
+
+	// high priority -> agents near the player must not wait behind chunk generation
+	batch->group_id = WorkerThreadPool::get_singleton()->add_template_group_task(
+		batch, &BakeBatch::bake_element, batch->jobs.size(), -1, true, "TerrainGenerator navigation bake"
+	);
+	batches.push_back(batch);
+	DEBUG_PRINT_OFTEN("NAVIGATION BAKE", batch->jobs.size(), "QUEUED", queue.size());
+}
+
+/*
+* CALLED FROM : update()
+* only waited on once completed -> never blocks the main thread
+*/
+void NavigationLayer::collect() {
+	for (uint32_t i = 0; i < batches.size();) {
+		BakeBatch *batch = batches[i];
+		if (!WorkerThreadPool::get_singleton()->is_group_task_completed(batch->group_id)) {
+			i++;
+			continue;
+		}
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(batch->group_id);
+		for (const BakeJob &job : batch->jobs) {
+			Tile *tile = tiles.getptr(job.chunk_pos);
+			// released or re-queued while baking
+			if (tile == nullptr || tile->version != job.version) {
+				continue;
+			}
+			if (!tile->region.is_valid()) {
+				tile->region = NavigationServer3D::get_singleton()->region_create();
+				NavigationServer3D::get_singleton()->region_set_navigation_layers(tile->region, navigation_layers);
+				NavigationServer3D::get_singleton()->region_set_map(tile->region, map);
+			}
+			NavigationServer3D::get_singleton()->region_set_navigation_mesh(tile->region, job.navigation_mesh);
+		}
+		memdelete(batch);
+		batches.remove_at_unordered(i);
+	}
+}
+
+void NavigationLayer::clear() {
+	for (BakeBatch *batch : batches) {
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(batch->group_id);
+		memdelete(batch);
+	}
+	batches.clear();
+	queue.clear();
+	for (const KeyValue<Vector3, Tile> &t : tiles) {
+		if (t.value.region.is_valid()) {
+			NavigationServer3D::get_singleton()->free(t.value.region);
+		}
+	}
+	tiles.clear();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "height_map_data.h"
+
+#include "scene/resources/navigation_mesh.h"
+#include "scene/resources/3d/navigation_mesh_source_geometry_data_3d.h"
+#include "servers/navigation_server_3d.h"
+
+/*
+* NAVIGATION TILES -> one NavigationServer region per resident chunk, baked straight from its height buffer
+*
+* the chunk image is snapshotted on the main thread (copy on write, so later edits never race the bake)
+* workers build the source geometry and run the Recast bake, the main thread only swaps finished navmeshes in
+* tiles are clipped to the chunk square (filter_baking_aabb) -> neighbouring tiles share their edges and connect
+* geometry reaches border_size past the square, from neighbour snapshots -> Recast does not erode the tile edges
+* main thread only
+*/
+class NavigationLayer {
+    struct BakeJob {
+        Vector3 chunk_pos;
+        uint32_t version = 0;
+        // FORMAT_RF pixels at queue time -> the chunk at NEIGHBOUR_CENTER, refined neighbours around it (empty if missing)
+        Vector<uint8_t> heights[9];
+        // pixels of neighbour data past the image on every side -> keeps border_size of geometry around the chunk
+        int padding = 0;
+        real_t height_at(int p_i, int p_j) const;
+        // duplicated from the template, baked in place by the worker
+        Ref<NavigationMesh> navigation_mesh;
+        real_t distance = 0.0;
+        bool operator<(const BakeJob &p_other) const { return distance < p_other.distance; }
+    };
+
+    struct BakeBatch {
+        LocalVector<BakeJob> jobs;
+        WorkerThreadPool::GroupID group_id = -1;
+        int sample_step = 2;
+        // Only for worker threads
+        void bake_element(uint32_t p_index);
+    };
+
+    struct Tile {
+        RID region;
+        // new on every queue -> results of outdated bakes are dropped
+        uint32_t version = 0;
+    };
+    // layer wide -> a released and re-queued tile never reuses the version of a bake still in flight
+    uint32_t last_version = 0;
+
+    RID map;
+    uint32_t navigation_layers = 1;
+    Ref<NavigationMesh> template_mesh;
+    // pixels between geometry vertices -> Recast voxelizes at cell_size anyway
+    int sample_step = 2;
+
+    // heights index -> (dz + 1) * 3 + (dx + 1)
+    static constexpr int NEIGHBOUR_CENTER = 4;
+
+    HashMap<Vector3, Tile> tiles;
+    LocalVector<BakeJob> queue;
+    LocalVector<BakeBatch *> batches;
+    static constexpr uint32_t MAX_BATCHES_IN_FLIGHT = 1;
+
+    void start_batch();
+    // pixels read from neighbours past the chunk image -> the image already reaches one step past the chunk square
+    static int get_padding(const Ref<NavigationMesh> &p_mesh) {
+        const real_t border = MAX(p_mesh->get_border_size(), p_mesh->get_agent_radius());
+        return MIN(MAX(0, int(Math::ceil(border / WorldData::STEP_SIZE)) - 1), int(WorldData::LENGTH / WorldData::STEP_SIZE));
+    }
+
+public:
+    void set_map(RID p_map) { map = p_map; }
+    void set_template(const Ref<NavigationMesh> &p_template) { template_mesh = p_template; }
+    Ref<NavigationMesh> get_template() const { return template_mesh; }
+    void set_navigation_layers(uint32_t p_layers);
+    uint32_t get_navigation_layers() const { return navigation_layers; }
+    void set_sample_step(int p_step) { sample_step = MAX(p_step, 1); }
+    int get_sample_step() const { return sample_step; }
+
+    // (re)bakes the chunk from its current heights -> a queued bake of the same chunk is replaced
+    // p_chunks -> resident chunks, refined neighbours extend the geometry past the chunk edge
+    void queue_bake(const HashMap<Vector3, Ref<HeightMapData>> &p_chunks, const Ref<HeightMapData> &p_hmap_data, const Vector3 &chunk_pos);
+    // re-bakes the neighbours that already have a tile -> only when their geometry reaches into this chunk
+    void queue_neighbours(const HashMap<Vector3, Ref<HeightMapData>> &p_chunks, const Vector3 &chunk_pos);
+    bool has_tile(const Vector3 &chunk_pos) const { return tiles.has(chunk_pos); }
+    // frees the region -> bakes still running for it are dropped when they finish
+    void release(const Vector3 &chunk_pos);
+
+    // applies finished bakes, then starts the next batch -> p_priority(chunk_pos) orders the queue, lowest first
+    template <typename T_Priority>
+    void update(T_Priority p_priority) {
+        collect();
+        if (queue.is_empty() || batches.size() >= MAX_BATCHES_IN_FLIGHT) {
+            return;
+        }
+        for (BakeJob &job : queue) {
+            job.distance = p_priority(job.chunk_pos);
+        }
+        queue.sort();
+        start_batch();
+    }
+    void collect();
+    // waits for running bakes and frees every region
+    void clear();
+
+    int get_tile_count() const { return tiles.size(); }
+    int get_queued_count() const { return queue.size(); }
+
+    ~NavigationLayer() { clear(); }
+};
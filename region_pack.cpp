@@ -0,0 +1,182 @@
+#include "region_pack.h"
+
+/*
+* one element per tile -> runs on worker threads
+*/
+struct RegionBakeJob {
+	LocalVector<Vector2i> tiles;
+	LocalVector<Vector<uint8_t>> blocks;
+	uint32_t batch_start = 0;
+
+	void bake_tile(uint32_t p_index, Compression::Mode p_mode) {
+		const Vector2i tile = tiles[batch_start + p_index];
+
+		Ref<HeightMapData> hmap_data;
+		hmap_data.instantiate();
+		hmap_data->generate_immediate(Vector3(tile.x, 0, tile.y));
+
+		const Vector<uint8_t> raw = hmap_data->get_image()->get_data();
+		Vector<uint8_t> &block = blocks[p_index];
+		block.resize(Compression::get_max_compressed_buffer_size(raw.size(), p_mode));
+		const int size = Compression::compress(block.ptrw(), raw.ptr(), raw.size(), p_mode);
+		block.resize(MAX(size, 0));
+	}
+};
+
+Error RegionPack::bake(const String &p_path, const Rect2i &p_region, bool p_fast_compression, int p_shard, int p_shard_count) {
+	ERR_FAIL_COND_V_MSG(p_region.size.x <= 0 || p_region.size.y <= 0, ERR_INVALID_PARAMETER, "Region pack bake region is empty.");
+	ERR_FAIL_COND_V_MSG(p_shard < 0 || p_shard >= p_shard_count, ERR_INVALID_PARAMETER, "Region pack shard out of range.");
+
+	const Compression::Mode mode = p_fast_compression ? Compression::MODE_FASTLZ : Compression::MODE_ZSTD;
+	HeightSource::get_active()->prepare();
+
+	RegionBakeJob job;
+	for (int z = p_region.position.y; z < p_region.position.y + p_region.size.y; z++) {
+		if ((z - p_region.position.y) % p_shard_count != p_shard) {
+			continue;
+		}
+		for (int x = p_region.position.x; x < p_region.position.x + p_region.size.x; x++) {
+			job.tiles.push_back(Vector2i(x, z));
+		}
+	}
+
+	// written next to the target and renamed once the index is in place -> a failed bake never leaves a pack open() accepts
+	const String temp_path = p_path + ".tmp";
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(temp_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot write region pack: " + temp_path);
+
+	f->store_32(MAGIC);
+	f->store_32(VERSION);
+	f->store_32(mode);
+	f->store_32(WorldData::H_RESOLUTION);
+	f->store_32(WorldData::LENGTH_EXP);
+	f->store_32(WorldData::STEP_EXP);
+	f->store_32(HeightSource::get_active()->get_config_hash());
+	f->store_32(job.tiles.size());
+
+	// index placeholder -> offsets are only known after compression
+	const uint64_t index_pos = f->get_position();
+	for (uint32_t i = 0; i < job.tiles.size(); i++) {
+		f->store_32(0);
+		f->store_32(0);
+		f->store_64(0);
+		f->store_32(0);
+	}
+
+	LocalVector<TileEntry> entries;
+	entries.resize(job.tiles.size());
+
+	for (uint32_t batch_start = 0; batch_start < job.tiles.size(); batch_start += BAKE_BATCH_SIZE) {
+		const uint32_t batch_size = MIN(BAKE_BATCH_SIZE, job.tiles.size() - batch_start);
+		job.batch_start = batch_start;
+		job.blocks.clear();
+		job.blocks.resize(batch_size);
+
+		WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(
+			&job, &RegionBakeJob::bake_tile, mode, batch_size, -1, true, "RegionPack bake"
+		);
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+
+		// blocks are written in tile order -> main thread only
+		for (uint32_t i = 0; i < batch_size; i++) {
+			const Vector<uint8_t> &block = job.blocks[i];
+			if (block.is_empty()) {
+				f.unref();
+				DirAccess::remove_absolute(temp_path);
+				ERR_FAIL_V_MSG(ERR_BUG, "Region pack tile failed to compress.");
+			}
+
+			entries[batch_start + i].offset = f->get_position();
+			entries[batch_start + i].compressed_size = block.size();
+			f->store_buffer(block.ptr(), block.size());
+		}
+		DEBUG_PRINT_RARE("REGION PACK BAKED", batch_start + batch_size, "/", job.tiles.size());
+	}
+
+	f->seek(index_pos);
+	for (uint32_t i = 0; i < job.tiles.size(); i++) {
+		f->store_32(job.tiles[i].x);
+		f->store_32(job.tiles[i].y);
+		f->store_64(entries[i].offset);
+		f->store_32(entries[i].compressed_size);
+	}
+	err = f->get_error();
+	f.unref();
+	if (err != OK) {
+		DirAccess::remove_absolute(temp_path);
+		ERR_FAIL_V_MSG(err, "Cannot write region pack: " + temp_path);
+	}
+	err = DirAccess::rename_absolute(temp_path, p_path);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot move region pack into place: " + p_path);
+	return OK;
+}
+
+Error RegionPack::open(const String &p_path) {
+	close();
+
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_path, FileAccess::READ, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot open region pack: " + p_path);
+	ERR_FAIL_COND_V_MSG(f->get_32() != MAGIC, ERR_FILE_UNRECOGNIZED, "Not a region pack: " + p_path);
+	ERR_FAIL_COND_V_MSG(f->get_32() != VERSION, ERR_FILE_UNRECOGNIZED, "Unsupported region pack version: " + p_path);
+
+	compression_mode = Compression::Mode(f->get_32());
+	resolution = f->get_32();
+	length_exp = f->get_32();
+	step_exp = f->get_32();
+	config_hash = f->get_32();
+
+	const uint32_t tile_count = f->get_32();
+	index.reserve(tile_count);
+	for (uint32_t i = 0; i < tile_count; i++) {
+		Vector2i tile;
+		tile.x = int32_t(f->get_32());
+		tile.y = int32_t(f->get_32());
+		TileEntry entry;
+		entry.offset = f->get_64();
+		entry.compressed_size = f->get_32();
+		index[tile] = entry;
+	}
+	file = f;
+	return OK;
+}
+
+void RegionPack::close() {
+	MutexLock lock(file_mutex);
+	file.unref();
+	index.clear();
+}
+
+bool RegionPack::read_chunk(const Vector3 &chunk_pos, Vector<uint8_t> &r_data) {
+	const TileEntry *entry = index.getptr(to_tile(chunk_pos));
+	if (entry == nullptr) {
+		return false;
+	}
+
+	Vector<uint8_t> block;
+	block.resize(entry->compressed_size);
+	{
+		MutexLock lock(file_mutex);
+		if (file.is_null()) {
+			return false;
+		}
+		file->seek(entry->offset);
+		if (file->get_buffer(block.ptrw(), block.size()) != uint64_t(block.size())) {
+			DEBUG_PRINT_ERROR("REGION PACK SHORT READ", chunk_pos);
+			return false;
+		}
+	}
+
+	r_data.resize(resolution * resolution * sizeof(float));
+	const int size = Compression::decompress(r_data.ptrw(), r_data.size(), block.ptr(), block.size(), compression_mode);
+	return size == r_data.size();
+}
+
+void RegionPack::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("open", "p_path"), &RegionPack::open);
+	ClassDB::bind_method(D_METHOD("close"), &RegionPack::close);
+	ClassDB::bind_method(D_METHOD("is_open"), &RegionPack::is_open);
+	ClassDB::bind_method(D_METHOD("is_compatible"), &RegionPack::is_compatible);
+	ClassDB::bind_method(D_METHOD("get_chunk_count"), &RegionPack::get_chunk_count);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "height_map_data.h"
+
+#include "core/io/compression.h"
+#include "core/io/dir_access.h"
+#include "core/io/file_access.h"
+
+/*
+* REGION PACK -> offline baked heightmaps for a fixed rectangle of chunks
+*
+* layout (little endian):
+* -> header : magic, version, compression mode, H_RESOLUTION, LENGTH_EXP, STEP_EXP, height source config hash, tile count
+* -> index  : per tile -> chunk x, chunk z, block offset, compressed size
+* -> blocks : per tile -> compressed FORMAT_RF pixels (H_RESOLUTION * H_RESOLUTION floats)
+*
+* heights are stored normalized, so amplitude/height_exp/offset can still change at runtime
+*/
+class RegionPack : public RefCounted {
+	GDCLASS(RegionPack, RefCounted);
+
+    struct TileEntry {
+        uint64_t offset = 0;
+        uint32_t compressed_size = 0;
+    };
+
+    // one handle shared by all workers -> only seek + read is locked, decompression is not
+    Ref<FileAccess> file;
+    Mutex file_mutex;
+    HashMap<Vector2i, TileEntry> index;
+
+    Compression::Mode compression_mode = Compression::MODE_ZSTD;
+    int resolution = 0;
+    uint8_t length_exp = 0;
+    uint8_t step_exp = 0;
+    // HeightSource::get_config_hash() at bake time -> noise parameters, seed or DEM set
+    uint32_t config_hash = 0;
+
+public:
+    static constexpr uint32_t MAGIC = 0x50524754;	// "TGRP"
+    static constexpr uint32_t VERSION = 2;
+    // tiles compressed per group task -> bounds memory use for large regions
+    static constexpr uint32_t BAKE_BATCH_SIZE = 256;
+
+    static Vector2i to_tile(const Vector3 &chunk_pos) { return Vector2i(int(chunk_pos.x), int(chunk_pos.z)); }
+
+    Error open(const String &p_path);
+    void close();
+
+    bool is_open() const { return file.is_valid(); }
+    // baked data only lines up with chunks generated at the same resolution from the same height source
+    bool is_compatible() const {
+        return resolution == WorldData::H_RESOLUTION && length_exp == WorldData::LENGTH_EXP && step_exp == WorldData::STEP_EXP
+            && config_hash == HeightSource::get_active()->get_config_hash();
+    }
+    bool has_chunk(const Vector3 &chunk_pos) const { return index.has(to_tile(chunk_pos)); }
+    int get_chunk_count() const { return index.size(); }
+
+    // thread safe -> called from worker threads
+    bool read_chunk(const Vector3 &chunk_pos, Vector<uint8_t> &r_data);
+
+    /*
+    * generate every chunk in p_region (chunk coordinates) with the current WorldData settings
+    * -> p_shard/p_shard_count bake every n-th row only, so several processes can split one region
+    */
+    static Error bake(const String &p_path, const Rect2i &p_region, bool p_fast_compression = false, int p_shard = 0, int p_shard_count = 1);
+
+	static void _bind_methods();
+
+    RegionPack() {}
+    ~RegionPack() { close(); }
+};
@@ -2,17 +2,29 @@
 
 #include "core/object/class_db.h"
 #include "terrain_generator.h"
+#include "terrain_benchmark.h"
 
 void initialize_terrain_generator_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
 	ClassDB::register_class<TerrainGenerator>();
+	ClassDB::register_class<TerrainRequest>();
+	ClassDB::register_class<RegionPack>();
+	ClassDB::register_abstract_class<HeightSource>();
+	ClassDB::register_class<NoiseHeightSource>();
+	ClassDB::register_class<DEMHeightSource>();
+	ClassDB::register_class<CompositeHeightSource>();
+	ClassDB::register_class<TerrainBenchmark>();
 }
 
 void uninitialize_terrain_generator_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
-   // Nothing to do here in this example.
+	TerrainTrace::finalize();
+	// shared by every lod ring -> released once, not per MeshData
+	WorldData::terrain_shader.unref();
+	WorldData::height_source.unref();
+	MeshData::clear_lod_mesh_cache();
 }
\ No newline at end of file
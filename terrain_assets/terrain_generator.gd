@@ -10,6 +10,12 @@ extends TerrainGenerator
 		terrain_shader = value
 		set_terrain_shader(terrain_shader)
 		
+# empty -> procedural noise, see DEMHeightSource/CompositeHeightSource for real-world elevation
+@export var height_source:HeightSource:
+	set(value):
+		height_source = value
+		set_height_source(value)
+		
 @export var terrain_amplitude:float = 16.0:
 	set(value):
 		terrain_amplitude = value
@@ -25,6 +31,21 @@ extends TerrainGenerator
 		terrain_offset = value
 		set_terrain_offset(value)
 
+@export var vegetation_mesh:Mesh:
+	set(value):
+		vegetation_mesh = value
+		set_scatter_mesh(value)
+
+@export var horizon_enabled:bool = false:
+	set(value):
+		horizon_enabled = value
+		set_horizon_enabled(value)
+
+@export var horizon_shader:Shader = preload("res://terrain_assets/horizon.gdshader"):
+	set(value):
+		horizon_shader = value
+		set_horizon_shader(value)
+
 # Called when the node enters the scene tree for the first time.
 func _enter_tree() -> void:
 	set_render_distance(8)
@@ -35,7 +56,11 @@ func _enter_tree() -> void:
 	
 	set_player_node_path(player_node_path)
 	set_terrain_shader(terrain_shader)
+	set_height_source(height_source)
 	set_terrain_offset(terrain_offset)
+	set_scatter_mesh(vegetation_mesh)
+	set_horizon_shader(horizon_shader)
+	set_horizon_enabled(horizon_enabled)
 	
 func _ready() -> void:
 	pass
@@ -0,0 +1,223 @@
+#include "terrain_benchmark.h"
+
+#include "core/io/json.h"
+#include "scene/main/scene_tree.h"
+
+void TerrainBenchmark::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_PROCESS:
+			if (state == RECORDING) {
+				record_frame();
+			} else if (state == REPLAYING) {
+				replay_frame_step();
+			}
+			break;
+		case NOTIFICATION_EXIT_TREE:
+			state = IDLE;
+			set_process(false);
+			break;
+	}
+}
+
+void TerrainBenchmark::start_recording() {
+	ERR_FAIL_NULL_MSG(get_target(), "TerrainBenchmark has no target node to record.");
+	path.clear();
+	state = RECORDING;
+	set_process(true);
+}
+
+void TerrainBenchmark::record_frame() {
+	Node3D *target = get_target();
+	if (target == nullptr) {
+		stop_recording();
+		return;
+	}
+	path.push_back(target->get_global_transform());
+}
+
+void TerrainBenchmark::start_replay() {
+	ERR_FAIL_COND_MSG(path.is_empty(), "TerrainBenchmark has no recorded path to replay.");
+	ERR_FAIL_NULL_MSG(get_target(), "TerrainBenchmark has no target node to drive.");
+	ERR_FAIL_NULL_MSG(get_terrain(), "TerrainBenchmark has no TerrainGenerator to measure.");
+
+	// --headless defaults to server mode -> replays always measure the client path, results stay comparable
+	if (get_terrain()->is_server_mode()) {
+		WARN_PRINT("TerrainBenchmark: switching the terrain out of server mode for the replay.");
+		get_terrain()->set_server_mode(false);
+	}
+
+	frame_usec.clear();
+	coverage_usec.clear();
+	last_frame_ticks = 0;
+	teleport_count = 0;
+	invisible_chunk_frames = 0;
+	replay_frame = 0;
+	state = REPLAYING;
+	set_process(true);
+}
+
+/*
+* frame time -> ticks between consecutive process notifications (whole engine frame)
+* teleport   -> jump between samples above teleport_distance, first frame counts as one (spawn)
+* coverage   -> ticks from the teleport until every lod slot has a resident chunk
+*/
+void TerrainBenchmark::replay_frame_step() {
+	const uint64_t now = OS::get_singleton()->get_ticks_usec();
+	if (last_frame_ticks != 0 && replay_frame > warmup_frames) {
+		frame_usec.push_back(now - last_frame_ticks);
+	}
+	last_frame_ticks = now;
+
+	if (replay_frame >= path.size()) {
+		finish_replay();
+		return;
+	}
+	Node3D *target = get_target();
+	TerrainGenerator *terrain = get_terrain();
+	if (target == nullptr || terrain == nullptr) {
+		finish_replay();
+		return;
+	}
+
+	const Transform3D &t = path[replay_frame];
+	if (replay_frame == 0 || t.origin.distance_to(path[replay_frame - 1].origin) > teleport_distance) {
+		teleport_count++;
+		teleport_ticks = now;
+		awaiting_coverage = true;
+	}
+	target->set_global_transform(t);
+
+	const int missing = terrain->get_missing_chunk_count();
+	invisible_chunk_frames += missing;
+	if (awaiting_coverage && missing == 0) {
+		coverage_usec.push_back(now - teleport_ticks);
+		awaiting_coverage = false;
+	}
+	replay_frame++;
+}
+
+void TerrainBenchmark::finish_replay() {
+	state = IDLE;
+	set_process(false);
+
+	Dictionary report = get_report();
+	DEBUG_PRINT_RARE("BENCHMARK", JSON::stringify(report));
+	if (!report_path.is_empty()) {
+		save_report(report_path);
+	}
+	emit_signal(SNAME("replay_finished"), report);
+
+	if (quit_on_finish && is_inside_tree()) {
+		const bool failed = max_hitches >= 0 && int(report["hitches"]) > max_hitches;
+		get_tree()->quit(failed ? 1 : 0);
+	}
+}
+
+Dictionary TerrainBenchmark::get_report() const {
+	LocalVector<uint64_t> sorted = frame_usec;
+	sorted.sort();
+
+	int hitches = 0;
+	uint64_t total_usec = 0;
+	for (uint64_t usec : frame_usec) {
+		hitches += usec / 1000.0 > hitch_threshold_ms;
+		total_usec += usec;
+	}
+	uint64_t coverage_total = 0;
+	uint64_t coverage_max = 0;
+	for (uint64_t usec : coverage_usec) {
+		coverage_total += usec;
+		coverage_max = MAX(coverage_max, usec);
+	}
+
+	Dictionary report;
+	report["frames"] = frame_usec.size();
+	report["mean_ms"] = frame_usec.is_empty() ? 0.0 : total_usec / 1000.0 / frame_usec.size();
+	report["p50_ms"] = percentile_ms(sorted, 0.50);
+	report["p95_ms"] = percentile_ms(sorted, 0.95);
+	report["p99_ms"] = percentile_ms(sorted, 0.99);
+	report["max_ms"] = sorted.is_empty() ? 0.0 : sorted[sorted.size() - 1] / 1000.0;
+	report["hitch_threshold_ms"] = hitch_threshold_ms;
+	report["hitches"] = hitches;
+	report["teleports"] = teleport_count;
+	// teleports whose area never filled before the path ended are not counted here
+	report["coverages"] = coverage_usec.size();
+	report["coverage_mean_ms"] = coverage_usec.is_empty() ? 0.0 : coverage_total / 1000.0 / coverage_usec.size();
+	report["coverage_max_ms"] = coverage_max / 1000.0;
+	report["invisible_chunk_frames"] = invisible_chunk_frames;
+	return report;
+}
+
+Error TerrainBenchmark::save_report(const String &p_file) const {
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_file, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot write benchmark report: " + p_file);
+	f->store_string(JSON::stringify(get_report(), "\t"));
+	return OK;
+}
+
+Error TerrainBenchmark::save_path(const String &p_file) const {
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_file, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot write benchmark path: " + p_file);
+	Array samples;
+	for (const Transform3D &t : path) {
+		samples.push_back(t);
+	}
+	f->store_var(samples);
+	return OK;
+}
+
+Error TerrainBenchmark::load_path(const String &p_file) {
+	Error err;
+	Ref<FileAccess> f = FileAccess::open(p_file, FileAccess::READ, &err);
+	ERR_FAIL_COND_V_MSG(f.is_null(), err, "Cannot read benchmark path: " + p_file);
+	Array samples = f->get_var();
+	path.clear();
+	for (int i = 0; i < samples.size(); i++) {
+		path.push_back(samples[i]);
+	}
+	return OK;
+}
+
+void TerrainBenchmark::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("start_recording"), &TerrainBenchmark::start_recording);
+	ClassDB::bind_method(D_METHOD("stop_recording"), &TerrainBenchmark::stop_recording);
+	ClassDB::bind_method(D_METHOD("start_replay"), &TerrainBenchmark::start_replay);
+	ClassDB::bind_method(D_METHOD("is_running"), &TerrainBenchmark::is_running);
+
+	ClassDB::bind_method(D_METHOD("save_path", "p_file"), &TerrainBenchmark::save_path);
+	ClassDB::bind_method(D_METHOD("load_path", "p_file"), &TerrainBenchmark::load_path);
+	ClassDB::bind_method(D_METHOD("get_path_length"), &TerrainBenchmark::get_path_length);
+	ClassDB::bind_method(D_METHOD("get_report"), &TerrainBenchmark::get_report);
+	ClassDB::bind_method(D_METHOD("save_report", "p_file"), &TerrainBenchmark::save_report);
+
+	ClassDB::bind_method(D_METHOD("set_target_node_path", "p_path"), &TerrainBenchmark::set_target_node_path);
+	ClassDB::bind_method(D_METHOD("set_terrain_node_path", "p_path"), &TerrainBenchmark::set_terrain_node_path);
+	ClassDB::bind_method(D_METHOD("set_teleport_distance", "p_distance"), &TerrainBenchmark::set_teleport_distance);
+	ClassDB::bind_method(D_METHOD("set_hitch_threshold_ms", "p_ms"), &TerrainBenchmark::set_hitch_threshold_ms);
+	ClassDB::bind_method(D_METHOD("set_warmup_frames", "p_frames"), &TerrainBenchmark::set_warmup_frames);
+	ClassDB::bind_method(D_METHOD("set_report_path", "p_file"), &TerrainBenchmark::set_report_path);
+	ClassDB::bind_method(D_METHOD("set_quit_on_finish", "p_quit"), &TerrainBenchmark::set_quit_on_finish);
+	ClassDB::bind_method(D_METHOD("set_max_hitches", "p_max"), &TerrainBenchmark::set_max_hitches);
+
+	ClassDB::bind_method(D_METHOD("get_target_node_path"), &TerrainBenchmark::get_target_node_path);
+	ClassDB::bind_method(D_METHOD("get_terrain_node_path"), &TerrainBenchmark::get_terrain_node_path);
+	ClassDB::bind_method(D_METHOD("get_teleport_distance"), &TerrainBenchmark::get_teleport_distance);
+	ClassDB::bind_method(D_METHOD("get_hitch_threshold_ms"), &TerrainBenchmark::get_hitch_threshold_ms);
+	ClassDB::bind_method(D_METHOD("get_warmup_frames"), &TerrainBenchmark::get_warmup_frames);
+	ClassDB::bind_method(D_METHOD("get_report_path"), &TerrainBenchmark::get_report_path);
+	ClassDB::bind_method(D_METHOD("get_quit_on_finish"), &TerrainBenchmark::get_quit_on_finish);
+	ClassDB::bind_method(D_METHOD("get_max_hitches"), &TerrainBenchmark::get_max_hitches);
+
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "target_node_path"), "set_target_node_path", "get_target_node_path");
+	ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "terrain_node_path"), "set_terrain_node_path", "get_terrain_node_path");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "teleport_distance"), "set_teleport_distance", "get_teleport_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "hitch_threshold_ms"), "set_hitch_threshold_ms", "get_hitch_threshold_ms");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "warmup_frames"), "set_warmup_frames", "get_warmup_frames");
+	ADD_PROPERTY(PropertyInfo(Variant::STRING, "report_path"), "set_report_path", "get_report_path");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "quit_on_finish"), "set_quit_on_finish", "get_quit_on_finish");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_hitches"), "set_max_hitches", "get_max_hitches");
+
+	ADD_SIGNAL(MethodInfo("replay_finished", PropertyInfo(Variant::DICTIONARY, "report")));
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "terrain_generator.h"
+
+/*
+* FLYTHROUGH BENCHMARK
+*
+* records the target node transform once per process frame, then replays it frame by frame
+* -> replay is tied to frame index, not wall time, so runs with --headless --fixed-fps are deterministic
+* -> measures whole frames, so _process, batch dispatch, chunk integration and collision rebuilds are all included
+*/
+class TerrainBenchmark : public Node {
+	GDCLASS(TerrainBenchmark, Node);
+
+	enum State { IDLE, RECORDING, REPLAYING };
+	State state = IDLE;
+
+	NodePath _target_node_path;
+	NodePath _terrain_node_path;
+
+	// one transform per process frame
+	Vector<Transform3D> path;
+	int replay_frame = 0;
+
+	/*
+	* REPLAY METRICS
+	*/
+	LocalVector<uint64_t> frame_usec;
+	LocalVector<uint64_t> coverage_usec;
+	uint64_t last_frame_ticks = 0;
+	uint64_t teleport_ticks = 0;
+	bool awaiting_coverage = false;
+	int teleport_count = 0;
+	// sum over frames of lod slots without a resident chunk
+	int64_t invisible_chunk_frames = 0;
+
+	// settings
+	real_t teleport_distance = 256.0;
+	real_t hitch_threshold_ms = 1000.0 / 30.0;
+	int warmup_frames = 0;
+	String report_path;
+	bool quit_on_finish = false;
+	// exit code 1 if exceeded -> -1 disables the gate
+	int max_hitches = -1;
+
+	Node3D *get_target() const {
+		return !_target_node_path.is_empty() ? cast_to<Node3D>(get_node_or_null(_target_node_path)) : nullptr;
+	}
+	TerrainGenerator *get_terrain() const {
+		return !_terrain_node_path.is_empty() ? cast_to<TerrainGenerator>(get_node_or_null(_terrain_node_path)) : nullptr;
+	}
+	static real_t percentile_ms(const LocalVector<uint64_t> &p_sorted, real_t p_percentile) {
+		if (p_sorted.is_empty()) return 0.0;
+		const uint32_t index = MIN(p_sorted.size() - 1, uint32_t(p_percentile * p_sorted.size()));
+		return p_sorted[index] / 1000.0;
+	}
+
+	void record_frame();
+	void replay_frame_step();
+	void finish_replay();
+
+protected:
+	static void _bind_methods();
+
+public:
+	void _notification(int p_what);
+
+	void start_recording();
+	void stop_recording() { state = IDLE; }
+	void start_replay();
+	bool is_running() const { return state != IDLE; }
+
+	Error save_path(const String &p_file) const;
+	Error load_path(const String &p_file);
+	int get_path_length() const { return path.size(); }
+
+	Dictionary get_report() const;
+	Error save_report(const String &p_file) const;
+
+	void set_target_node_path(const NodePath &p_path) { _target_node_path = p_path; }
+	void set_terrain_node_path(const NodePath &p_path) { _terrain_node_path = p_path; }
+	void set_teleport_distance(const real_t &p_distance) { teleport_distance = p_distance; }
+	void set_hitch_threshold_ms(const real_t &p_ms) { hitch_threshold_ms = p_ms; }
+	void set_warmup_frames(const int &p_frames) { warmup_frames = MAX(p_frames, 0); }
+	void set_report_path(const String &p_file) { report_path = p_file; }
+	void set_quit_on_finish(const bool &p_quit) { quit_on_finish = p_quit; }
+	void set_max_hitches(const int &p_max) { max_hitches = p_max; }
+
+	NodePath get_target_node_path() const { return _target_node_path; }
+	NodePath get_terrain_node_path() const { return _terrain_node_path; }
+	real_t get_teleport_distance() const { return teleport_distance; }
+	real_t get_hitch_threshold_ms() const { return hitch_threshold_ms; }
+	int get_warmup_frames() const { return warmup_frames; }
+	String get_report_path() const { return report_path; }
+	bool get_quit_on_finish() const { return quit_on_finish; }
+	int get_max_hitches() const { return max_hitches; }
+
+	TerrainBenchmark() {}
+	~TerrainBenchmark() {}
+};
@@ -4,12 +4,20 @@
 #include "scene/resources/3d/primitive_meshes.h"
 #include "scene/resources/mesh_data_tool.h"
 #include "scene/3d/mesh_instance_3d.h"
+#include "servers/display_server.h"
 
 /*
 NOTE: 
 -> chunk is not a real class/type -> it's a mesh and a heightmap referred together
 */
 TerrainGenerator::TerrainGenerator() {
+	// observer 0 -> player, drawn on the default render layer, owns the default collision patch
+	observers.resize(1);
+	observers[0].layer_mask = 1;
+	observers[0].has_collision = true;
+	// exported dedicated server builds and --headless runs start render-less
+	server_mode = OS::get_singleton()->has_feature("dedicated_server")
+		|| (DisplayServer::get_singleton() != nullptr && DisplayServer::get_singleton()->get_name() == "headless");
 }
 TerrainGenerator::~TerrainGenerator() {
 }
@@ -35,8 +43,19 @@ void TerrainGenerator::_notification(int p_what) {
 			_process(get_process_delta_time());
 			break;
 		case NOTIFICATION_VISIBILITY_CHANGED: {
-			for (KeyValue<Vector2i, Ref<MeshData>> m : lod_meshes) {
-				m.value->set_visiblity(is_visible_in_tree());
+			for (Observer &o : observers) {
+				for (KeyValue<Vector2i, Ref<MeshData>> m : o.lod_meshes) {
+					m.value->set_visiblity(is_visible_in_tree() && chunk_table.has(m.value->get_chunk_pos()));
+				}
+			}
+			if (horizon.is_valid()) {
+				horizon->set_visiblity(is_visible_in_tree());
+			}
+			for (KeyValue<Vector3, Ref<HeightMapData>> c : chunk_table) {
+				Ref<ScatterData> scatter_data = c.value->get_scatter_data();
+				if (scatter_data.is_valid()) {
+					scatter_data->set_visiblity(is_visible_in_tree() && scatter_data->get_instance_count() > 0);
+				}
 			}
 		} break;
 	}
@@ -45,7 +64,9 @@ void TerrainGenerator::_notification(int p_what) {
 void TerrainGenerator::_enter_tree() {
 	// just in case...
 	create_tasks.clear();
-	lod_meshes.clear();
+	for (Observer &o : observers) {
+		o.lod_meshes.clear();
+	}
 	chunk_table.clear();
 
 	// set scenario for custom mesh instances
@@ -57,6 +78,7 @@ void TerrainGenerator::_enter_tree() {
     WorldData::LENGTH_EXP = 6;
     WorldData::LENGTH = 1 << WorldData::LENGTH_EXP;
     WorldData::H_RESOLUTION = (1 << (WorldData::LENGTH_EXP - WorldData::STEP_EXP)) + 1 + 2;
+    WorldData::SEED = seed;
 	// determines heights
     WorldData::AMPLITUDE = 1.0;
 	WorldData::HEIGHT_EXP = 1.0;
@@ -68,77 +90,90 @@ void TerrainGenerator::_enter_tree() {
     WorldData::FRACTAL_OCTAVES = 10.0;
     WorldData::FRACTAL_LACUNARITY = 2.0;
     WorldData::FRACTAL_GAIN = 0.45;
-
-	/*
-	* COLLISION SETUP -> godot managed, do not make direct memory modifications
-	*/
-	collision_map = memnew(CollisionShape3D);
-	static_body_3d = memnew(StaticBody3D);
-	static_body_3d->add_child(collision_map);
-	add_child(static_body_3d);
-	collision_shape = memnew(ConcavePolygonShape3D);
 }
 
 void TerrainGenerator::_exit_tree() {
 	set_process(false);
 	set_physics_process(false);
 
-	if (!create_tasks.is_empty()) {
-		for (auto &t : create_tasks) {
-			WorkerThreadPool::get_singleton()->wait_for_task_completion(t.value);
+	wait_generation_batches();
+	create_queue.clear();
+	create_tasks.clear();
+	burst_chunks.clear();
+	navigation.clear();
+	{
+		MutexLock lock(ready_mutex);
+		ready_chunks.clear();
+	}
+	pending_chunks.clear();
+	// deformation deltas are kept -> edits survive re-initialization
+	dirty_chunks.clear();
+	collision_dirty = false;
+	for (Observer &o : observers) {
+		clear_lod_ring(o);
+		clear_collision(o);
+		o.active = false;
+	}
+	// waits for a running refresh before its images are freed
+	horizon.unref();
+	// completed requests are dropped with their chunks, pending ones are re-queued after _ready
+	for (uint32_t i = 0; i < requests.size();) {
+		if (requests[i].request->is_completed()) {
+			release_request(i);
+			continue;
 		}
+		i++;
 	}
-	create_tasks.clear();
-	for (auto &m : lod_meshes) {
-		m.value->set_visiblity(false);
+	for (auto &c : chunk_table) {
+		if (c.value->get_scatter_data().is_valid()) {
+			c.value->get_scatter_data()->set_visiblity(false);
+		}
 	}
-	lod_meshes.clear();
 	chunk_table.clear();
-
-	_manual_collision_update = false;
 }
 
 /*
 * READY
 */
 void TerrainGenerator::_ready() {
-	if (_player_node_path.is_empty()) return;
+	// a server may start before any player has connected
+	if (_player_node_path.is_empty() && !server_mode) return;
 
-	RS::get_singleton()->global_shader_parameter_set("amplitude", WorldData::AMPLITUDE);
-	RS::get_singleton()->global_shader_parameter_set("vert_step_size", WorldData::STEP_SIZE);
-	RS::get_singleton()->global_shader_parameter_set("clipmap_partition_length", WorldData::LENGTH);
-	RS::get_singleton()->global_shader_parameter_set("height_exp", WorldData::HEIGHT_EXP);
+	if (!server_mode) {
+		RS::get_singleton()->global_shader_parameter_set("amplitude", WorldData::AMPLITUDE);
+		RS::get_singleton()->global_shader_parameter_set("vert_step_size", WorldData::STEP_SIZE);
+		RS::get_singleton()->global_shader_parameter_set("clipmap_partition_length", WorldData::LENGTH);
+		RS::get_singleton()->global_shader_parameter_set("height_exp", WorldData::HEIGHT_EXP);
+	}
 	/*
 	GENERATE ALL LOD MESHES
 	*/
 	WorldData::LOD_LIMIT = WorldData::LENGTH_EXP - WorldData::STEP_EXP - 1.0;
+	tune_tile_size();
+	HeightSource::get_active()->prepare();
+	navigation.set_map(get_world_3d()->get_navigation_map());
+	navigation_scan = true;
 
-	for (int z = -render_distance; z <= render_distance; z++) {
-		for (int x = -render_distance; x <= render_distance; x++) {
-			if (player_chunk.distance_to(Vector3(x, 0, z)) >= render_distance) {
-				continue;
-			}
-			Vector2i coord = {x, z};
-			lod_meshes[coord].instantiate(LODS(x,z,WorldData::LOD_LIMIT), Vector3(x,0,z));
-		}
-	}
 	// + LENGTH -> chunks are added before deletion in process()
-	chunk_table.reserve(lod_meshes.size() + WorldData::LENGTH);
-	reuse_pool.resize(render_distance);
+	const int radius = get_interest_radius();
+	const int circle_size = (2 * radius + 1) * (2 * radius + 1);
+	chunk_table.reserve(observers.size() * circle_size + WorldData::LENGTH);
+	reuse_pool.resize(radius);
+	// workers start on the nearest chunks while the rings are built below
+	queue_initial_burst();
+
+	for (Observer &o : observers) {
+		build_lod_ring(o);
+	}
+	build_horizon();
 	/*
 	* SETUP COLLISION MAP
 	*/
 	collision_size.x = 32 * WorldData::STEP_SIZE;
 	collision_size.y = 32 * WorldData::STEP_SIZE;
-	int sub_div = 31;
-	// initial mesh -> will not need later
-	PlaneMesh collision_mesh;
-	collision_mesh.set_size(collision_size);
-	collision_mesh.set_subdivide_width(sub_div);
-	collision_mesh.set_subdivide_depth(sub_div);
-	shape_faces = Variant(collision_mesh.get_faces());
-	collision_shape->set_faces(shape_faces);
-	collision_map->set_shape(collision_shape);
+	for (Observer &o : observers) {
+		build_collision(o);
+	}
 
 	/*
 	* FINALIZE
@@ -146,10 +181,84 @@ void TerrainGenerator::_ready() {
 	set_process(true);
 	set_physics_process(true);
 	ready_queued.store(false);
-	_manual_collision_update = false;
-	
-	// initial collision map
-	update_shape(-1, -1);
+}
+
+/*
+* CALLED FROM : _ready()
+* observers are placed here -> rings are built around the right chunk and update_observer only queues the rest
+*/
+void TerrainGenerator::queue_initial_burst() {
+	if (initial_burst_radius == 0) {
+		return;
+	}
+	const int radius = MIN(initial_burst_radius, get_interest_radius());
+	for (Observer &o : observers) {
+		Node3D *node = get_observer_node(o);
+		o.active = node != nullptr;
+		if (!o.active) {
+			continue;
+		}
+		o.chunk = calculate_chunk(node->get_global_position());
+		for (int z = -radius; z <= radius; z++) {
+			for (int x = -radius; x <= radius; x++) {
+				const Vector3 chunk_pos = o.chunk + Vector3(x, 0, z);
+				if (Vector3(x, 0, z).length() >= radius + 0.5 || chunk_table.has(chunk_pos) || create_tasks.has(chunk_pos)) {
+					continue;
+				}
+				create_tasks[chunk_pos] = WorkerThreadPool::INVALID_TASK_ID;
+				create_queue.push_back({ chunk_pos });
+				burst_chunks.insert(chunk_pos);
+			}
+		}
+	}
+	DEBUG_PRINT_RARE("INITIAL BURST", burst_chunks.size());
+	dispatch_generation_batches();
+}
+
+/*
+* CALLED FROM : _ready() add_observer()
+* initial collision map is flat -> filled on the first physics tick with resident chunks
+*/
+void TerrainGenerator::build_collision(Observer &p_observer) {
+	if (!p_observer.has_collision) {
+		return;
+	}
+	create_patch(p_observer.collision, collision_size, 31);
+}
+
+void TerrainGenerator::clear_collision(Observer &p_observer) {
+	free_patch(p_observer.collision);
+}
+
+/*
+* COLLISION SETUP -> godot managed, do not make direct memory modifications
+* p_subdivisions -> vertices per side minus two, one quad per height step keeps every pixel
+*/
+void TerrainGenerator::create_patch(CollisionPatch &r_patch, const Size2 &p_size, int p_subdivisions) {
+	if (r_patch.static_body_3d == nullptr) {
+		r_patch.collision_map = memnew(CollisionShape3D);
+		r_patch.static_body_3d = memnew(StaticBody3D);
+		r_patch.static_body_3d->add_child(r_patch.collision_map);
+		add_child(r_patch.static_body_3d);
+		r_patch.collision_shape.instantiate();
+	}
+	r_patch.size = p_size;
+	// initial mesh -> will not need later
+	PlaneMesh collision_mesh;
+	collision_mesh.set_size(p_size);
+	collision_mesh.set_subdivide_width(p_subdivisions);
+	collision_mesh.set_subdivide_depth(p_subdivisions);
+	r_patch.shape_faces = Variant(collision_mesh.get_faces());
+	r_patch.collision_shape->set_faces(r_patch.shape_faces);
+	r_patch.collision_map->set_shape(r_patch.collision_shape);
+	r_patch.manual_update = true;
+}
+
+void TerrainGenerator::free_patch(CollisionPatch &r_patch) {
+	if (r_patch.static_body_3d != nullptr) {
+		r_patch.static_body_3d->queue_free();
+	}
+	r_patch = CollisionPatch();
 }
 
 
@@ -160,29 +269,48 @@ void TerrainGenerator::_ready() {
 * perhaps reduce subdivisions to 15x15 or even 7x7
 */
 void TerrainGenerator::_physics_process(double physics_delta) {
-	if (_player_node_path.is_empty()) return;
-
 	// snap to nearest Chunk quadrant
 	real_t snap = collision_size.x / 2.0;
-	Vector3 player_rounded_position = (get_player()->get_global_position()).snappedf(snap);
-	player_rounded_position.y = 0.0;
 
-	if (collision_map->get_global_position() != player_rounded_position || _manual_collision_update) {
-		collision_map->set_global_position(player_rounded_position);
+	for (Observer &o : observers) {
+		CollisionPatch &patch = o.collision;
+		Node3D *node = get_observer_node(o);
+		if (patch.static_body_3d == nullptr || node == nullptr) {
+			continue;
+		}
+		Vector3 observer_rounded_position = node->get_global_position().snappedf(snap);
+		observer_rounded_position.y = 0.0;
+
+		if (patch.collision_map->get_global_position() != observer_rounded_position || patch.manual_update) {
+			patch.collision_map->set_global_position(observer_rounded_position);
 
-		Vector3 center = calculate_player_chunk() * WorldData::LENGTH;
-		int x = (player_rounded_position.x <= center.x) ? -1 : 1;
-		int z = (player_rounded_position.z <= center.z) ? -1 : 1;
-		update_shape(x, z);
+			Vector3 center = calculate_chunk(node->get_global_position()) * WorldData::LENGTH;
+			int x = (observer_rounded_position.x <= center.x) ? -1 : 1;
+			int z = (observer_rounded_position.z <= center.z) ? -1 : 1;
+			update_shape(o, x, z);
+		}
+		else if (collision_dirty) {
+			update_shape_region(patch, collision_dirty_rect);
+		}
+	}
+	if (collision_dirty) {
+		for (PendingRequest &r : requests) {
+			if (r.patch.static_body_3d != nullptr) {
+				update_shape_region(r.patch, collision_dirty_rect);
+			}
+		}
 	}
+	collision_dirty = false;
 }
 
 /*
-* CALLED FROM : _ready() _physics_process()
+* CALLED FROM : _physics_process()
 */
-void TerrainGenerator::update_shape(int x, int z) {
-	// need to re-calculate player_chunk -> _physics_process is faster (120 tics) than _process (60 tics)
-	Vector3 p_chunk = calculate_player_chunk();
+void TerrainGenerator::update_shape(Observer &p_observer, int x, int z) {
+	TERRAIN_TRACE_SCOPE("update_shape");
+	CollisionPatch &patch = p_observer.collision;
+	// need to re-calculate the observer chunk -> _physics_process is faster (120 tics) than _process (60 tics)
+	Vector3 p_chunk = calculate_chunk(get_observer_node(p_observer)->get_global_position());
 	/*
 	* Prepare nearest chunk HeightMapData based on quadrant offset
 	*/
@@ -196,8 +324,9 @@ void TerrainGenerator::update_shape(int x, int z) {
 	Vector<Ref<HeightMapData>> nearest;
 	for (auto v : positions) {
 		auto itr = chunk_table.find(v);
-		_manual_collision_update = itr == chunk_table.end();
-		if (_manual_collision_update) { 
+		// coarse chunks count as missing -> collision is only built from refined heights
+		patch.manual_update = itr == chunk_table.end() || !itr->value->is_refined();
+		if (patch.manual_update) { 
 			return;
 		}
 		nearest.push_back(itr->value);
@@ -205,8 +334,9 @@ void TerrainGenerator::update_shape(int x, int z) {
 	DEBUG_PRINT_OFTEN("UPDATE COLLISION SHAPE");
 
 	// Adjust shape_faces heights based on nearest chunks
-	for (auto &face : shape_faces) {
-		Vector3 global_vert = face + collision_map->get_global_position();
+	const Vector3 origin = patch.collision_map->get_global_position();
+	for (auto &face : patch.shape_faces) {
+		Vector3 global_vert = face + origin;
 		face.y = get_height(nearest, global_vert, true);
 	}
 	if (!heights_not_found.is_empty()) {
@@ -214,112 +344,593 @@ void TerrainGenerator::update_shape(int x, int z) {
 		heights_not_found.clear();
 	}
 	// update shape faces
-	collision_shape->set_faces(shape_faces);
+	patch.collision_shape->set_faces(patch.shape_faces);
+}
+
+
+/*
+* CALLED FROM : _physics_process() -> after terrain edits
+* set_faces still rebuilds the shape, but only vertices inside the edit are re-sampled
+*/
+void TerrainGenerator::update_shape_region(CollisionPatch &r_patch, const Rect2 &p_rect) {
+	TERRAIN_TRACE_SCOPE("update_shape_region");
+	const Vector3 origin = r_patch.collision_map->get_global_position();
+	if (!get_patch_rect(r_patch).intersects(p_rect)) {
+		return;
+	}
+	Vector<Ref<HeightMapData>> nearest;
+	for (auto &c : chunk_table) {
+		const Vector3 start = c.value->get_start_pos();
+		const Rect2 chunk_rect(start.x, start.z, WorldData::LENGTH, WorldData::LENGTH);
+		if (chunk_rect.intersects(p_rect) && c.value->is_refined()) {
+			nearest.push_back(c.value);
+		}
+	}
+	if (nearest.is_empty()) {
+		return;
+	}
+	DEBUG_PRINT_OFTEN("UPDATE COLLISION REGION", p_rect);
+
+	// merged dirty rects can span missing or coarse chunks -> vertices no chunk covers keep their old height
+	for (auto &face : r_patch.shape_faces) {
+		Vector3 global_vert = face + origin;
+		if (!p_rect.has_point(Vector2(global_vert.x, global_vert.z))) {
+			continue;
+		}
+		for (const Ref<HeightMapData> &h : nearest) {
+			if (h->in_bounds(global_vert)) {
+				face.y = h->get_height_global(global_vert);
+				break;
+			}
+		}
+	}
+	r_patch.collision_shape->set_faces(r_patch.shape_faces);
+}
+
+/*
+* HEIGHT QUERIES -> same heights the collision shapes are built from, interpolated between pixels
+*/
+real_t TerrainGenerator::get_height_at(const Vector3 &p_position) const {
+	const Ref<HeightMapData> *hmap_data = find_chunk_at(p_position);
+	return hmap_data != nullptr ? (*hmap_data)->sample_height(p_position) : NAN;
 }
 
+Vector3 TerrainGenerator::get_normal_at(const Vector3 &p_position) const {
+	const Ref<HeightMapData> *hmap_data = find_chunk_at(p_position);
+	if (hmap_data == nullptr) {
+		return Vector3();
+	}
+	// central differences stay inside this chunk's padding
+	const real_t step = WorldData::STEP_SIZE;
+	const real_t dx = (*hmap_data)->sample_height(p_position + Vector3(step, 0, 0)) - (*hmap_data)->sample_height(p_position - Vector3(step, 0, 0));
+	const real_t dz = (*hmap_data)->sample_height(p_position + Vector3(0, 0, step)) - (*hmap_data)->sample_height(p_position - Vector3(0, 0, step));
+	return Vector3(-dx, 2.0 * step, -dz).normalized();
+}
 
 /*
 * PROCESS
 */
 void TerrainGenerator::_process(double delta) {
-	if (_player_node_path.is_empty()) return;
+	if (_player_node_path.is_empty() && !server_mode) return;
+	TERRAIN_TRACE_SCOPE("TerrainGenerator::_process");
+
+	// finished chunks are integrated every frame, even when no observer has moved
+	integrate_ready_chunks();
+	flush_dirty_chunks();
+	update_requests();
+
+	bool changed = false;
+	for (uint32_t i = 0; i < observers.size(); i++) {
+		const bool player_moved = update_observer(observers[i]);
+		if (i == 0 && player_moved && !server_mode) {
+			// kept for shaders that still read the global -> ring materials get their own center
+			RS::get_singleton()->global_shader_parameter_set("clipmap_position", observers[0].chunk * WorldData::LENGTH);
+		}
+		changed |= player_moved;
+	}
+	if (horizon.is_valid() && observers[0].active) {
+		horizon->update(get_observer_node(observers[0])->get_global_position(), observers[0].chunk * WorldData::LENGTH);
+	}
+	if (changed) {
+		delete_far_away_chunks();
+		navigation_scan = true;
+	}
+	dispatch_generation_batches();
+	update_navigation();
+}
+
+/*
+* CALLED FROM : _process()
+* chunks already queued by another observer are not queued twice -> the shared create_tasks dedups
+*/
+bool TerrainGenerator::update_observer(Observer &p_observer) {
+	Node3D *node = get_observer_node(p_observer);
+	p_observer.active = node != nullptr;
+	if (!p_observer.active) {
+		return false;
+	}
 	/*
 	TODO: account for diagonal chunk movement
 	*/
-	Vector3 new_player_chunk = calculate_player_chunk();
+	const Vector3 new_chunk = calculate_chunk(node->get_global_position());
+	const int radius = get_interest_radius();
 
 	// check if we do not need to update
-	if (player_chunk == new_player_chunk && !update_check()) { 
-		return;
+	if (p_observer.chunk == new_chunk && !update_check(new_chunk)) {
+		return false;
+	}
+	if (p_observer.chunk != new_chunk) {
+		for (auto &m : p_observer.lod_meshes) {
+			m.value->set_clipmap_position(new_chunk * WorldData::LENGTH);
+		}
 	}
-	RS::get_singleton()->global_shader_parameter_set("clipmap_position", new_player_chunk * WorldData::LENGTH);
 
 	// Try to generate chunks ahead of time based on where the player is moving.
 	//player_chunk.y += round(CLAMP(player_character->get_velocity().y, -render_distance/4, render_distance/4));
 
 	/*
-	* priority based chunk processing -> spawn/update chunks according to player view direction
+	* priority based chunk processing -> spawn/update chunks according to observer view direction
 	* for now, only considers 4 directions (diagonals) -> considering 8 directions in the future
 	*/
-	double yaw = get_player()->get_global_rotation_degrees().y;
+	double yaw = node->get_global_rotation_degrees().y;
 	bool x_flip = yaw < 0.0 && yaw >= -180.0;
 	bool z_flip = yaw > 90.0 || yaw <= -90.0;
-	range_flip x_range(-render_distance, render_distance, x_flip);
-	range_flip z_range(-render_distance, render_distance, z_flip);
+	range_flip x_range(-radius, radius, x_flip);
+	range_flip z_range(-radius, radius, z_flip);
 
 	// check chunks from outside in -> queues create tasks first
 	for (int x : x_range) {
 		for (int z : z_range) {
 			Vector2i grid_pos = Vector2i(x, z);
-			Vector3 chunk_pos = new_player_chunk + Vector3(x, 0, z);
+			Vector3 chunk_pos = new_chunk + Vector3(x, 0, z);
 
-			bool distance_check = new_player_chunk.distance_to(chunk_pos) >= render_distance;
-			if (distance_check || create_tasks.has(chunk_pos)) continue;
+			if (new_chunk.distance_to(chunk_pos) >= radius) continue;
 
 			auto chunk_itr = chunk_table.find(chunk_pos);
-			auto mesh_itr = lod_meshes.find(grid_pos);
-			auto mesh_val = mesh_itr->value;
+			auto mesh_itr = p_observer.lod_meshes.find(grid_pos);
+			Ref<MeshData> mesh_val = mesh_itr != p_observer.lod_meshes.end() ? mesh_itr->value : Ref<MeshData>();
 
 			if (chunk_itr == chunk_table.end()) {
-				// CREATE NEW/REUSE CHUNK
-				mesh_val->set_visiblity(false);
-				create_tasks[chunk_pos] = WorkerThreadPool::INVALID_TASK_ID;
-				create_queue.push(callable_mp(this, &TerrainGenerator::push_create_task).bind(chunk_pos, grid_pos));
+				// CREATE NEW/REUSE CHUNK -> slot stays hidden until the chunk is integrated
+				if (mesh_val.is_valid()) {
+					mesh_val->set_visiblity(false);
+				}
+				if (!create_tasks.has(chunk_pos)) {
+					create_tasks[chunk_pos] = WorkerThreadPool::INVALID_TASK_ID;
+					create_queue.push_back({ chunk_pos });
+				}
 			}
-			else if (chunk_pos != mesh_val->get_chunk_pos()) {
+			else if (mesh_val.is_valid() && chunk_pos != mesh_val->get_chunk_pos()) {
 				// UPDATE CHUNKS
 				DEBUG_PRINT_OFTEN("UPDATE MESH DATA", chunk_pos);
 				mesh_val->update(chunk_itr->value->get_image(), chunk_pos);
 			}
-			/*
-			* START TASK CALL-CHAIN
-			*
-			* tasks calls next task at completion -> chained calls
-			* one task needed to start
-			* ((create_tasks/queue).size() == 1) -> no tasks are running, start task
-			*/
-			if (create_tasks.size() != 1 || create_queue.size() != 1) { 
+		}
+	}
+	p_observer.chunk = new_chunk;
+	return true;
+}
+
+/*
+* CALLED FROM : _ready() add_observer() set_player_layer_mask()
+* slots whose chunk is already resident are filled right away -> a late observer reuses the shared table
+*/
+void TerrainGenerator::build_lod_ring(Observer &p_observer) {
+	clear_lod_ring(p_observer);
+	if (p_observer.layer_mask == 0 || server_mode) {
+		return;
+	}
+	HashSet<int> lods;
+	for (int z = -render_distance; z <= render_distance; z++) {
+		for (int x = -render_distance; x <= render_distance; x++) {
+			lods.insert(LODS(x,z,WorldData::LOD_LIMIT)[LODS::CENTER]);
+		}
+	}
+	MeshData::prepare_lod_meshes(lods);
+
+	for (int z = -render_distance; z <= render_distance; z++) {
+		for (int x = -render_distance; x <= render_distance; x++) {
+			if (Vector3(x, 0, z).length() >= render_distance) {
 				continue;
 			}
-			create_queue.front().call_deferred();
-			create_queue.pop();
+			Vector2i coord = {x, z};
+			Ref<MeshData> &mesh = p_observer.lod_meshes[coord];
+			mesh.instantiate(LODS(x,z,WorldData::LOD_LIMIT), Vector3(x,0,z));
+			mesh->set_layer_mask(p_observer.layer_mask);
+			mesh->set_clipmap_position(p_observer.chunk * WorldData::LENGTH);
+
+			Vector3 chunk_pos = p_observer.chunk + Vector3(x, 0, z);
+			auto chunk_itr = chunk_table.find(chunk_pos);
+			if (chunk_itr != chunk_table.end()) {
+				mesh->update(chunk_itr->value->get_image(), chunk_pos);
+			}
+			else {
+				mesh->set_visiblity(false);
+			}
 		}
 	}
+}
+
+void TerrainGenerator::clear_lod_ring(Observer &p_observer) {
+	for (auto &m : p_observer.lod_meshes) {
+		m.value->set_visiblity(false);
+	}
+	p_observer.lod_meshes.clear();
+}
 
-	player_chunk = new_player_chunk;
-	delete_far_away_chunks();
+/*
+* about two tiles per worker for a single chunk -> teleport/spawn chunks still use every core
+* larger tiles only add per-element overhead once several chunks share a batch
+*/
+void TerrainGenerator::tune_tile_size() {
+	if (tile_size_override > 0) {
+		WorldData::TILE_SIZE = tile_size_override;
+		return;
+	}
+	const int threads = MAX(1, WorkerThreadPool::get_singleton()->get_thread_count());
+	const int tiles_per_side = MAX(1, int(Math::ceil(Math::sqrt(2.0 * threads))));
+	WorldData::TILE_SIZE = MAX(MIN_TILE_SIZE, Math::division_round_up(WorldData::H_RESOLUTION, tiles_per_side));
+	DEBUG_PRINT_RARE("TILE SIZE", WorldData::TILE_SIZE, "TILES PER CHUNK", HeightMapData::get_tile_count());
 }
 
 /*
 * CALLED FROM : _process()
+* releases finished batches, then builds a new one from the nearest queued chunks
 */
-void TerrainGenerator::create_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos, Vector2i grid_pos) {
-	hmap_data->_instantiate(
-		chunk_pos, callable_mp(this, &TerrainGenerator::add_chunk).bind(hmap_data, chunk_pos, grid_pos)
+void TerrainGenerator::dispatch_generation_batches() {
+	TERRAIN_TRACE_SCOPE("dispatch_generation_batches");
+	// every group task has to be waited on once -> only done when already completed, never blocks
+	for (uint32_t i = 0; i < generation_batches.size();) {
+		GenerationBatch *batch = generation_batches[i];
+		if (!WorkerThreadPool::get_singleton()->is_group_task_completed(batch->group_id)) {
+			i++;
+			continue;
+		}
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(batch->group_id);
+		memdelete(batch);
+		generation_batches.remove_at_unordered(i);
+	}
+	if (create_queue.is_empty() || generation_batches.size() >= MAX_BATCHES_IN_FLIGHT) {
+		return;
+	}
+
+	// nearest to any observer first -> every viewport fills its center before its edge
+	for (QueuedChunk &q : create_queue) {
+		// pinned chunks and chunks under collision/navigation are refined first -> they wait for final heights
+		if (q.refine_data.is_valid() && !is_pinned(q.chunk_pos)) {
+			q.distance = needs_final_heights(q.chunk_pos) ? -1.0 : get_priority(q.chunk_pos) + REFINE_PRIORITY_OFFSET;
+			continue;
+		}
+		q.distance = get_priority(q.chunk_pos);
+	}
+	create_queue.sort();
+
+	// the initial burst goes out as one batch -> its tiles are spread over every worker at once
+	const uint32_t chunk_limit = MAX(1, MAX(WorkerThreadPool::get_singleton()->get_thread_count(), int(burst_chunks.size())));
+	const Ref<HeightSource> source = HeightSource::get_active();
+	for (uint32_t i = 0; i < MIN(create_queue.size(), chunk_limit * READ_AHEAD_BATCHES); i++) {
+		const Vector3 chunk_pos = create_queue[i].chunk_pos;
+		if (find_region_pack(chunk_pos).is_null()) {
+			source->prefetch(HeightMapData::get_sample_area(chunk_pos));
+		}
+	}
+	GenerationBatch *batch = memnew(GenerationBatch);
+	uint32_t taken = 0;
+	for (; taken < create_queue.size() && batch->size() < chunk_limit; taken++) {
+		const Vector3 chunk_pos = create_queue[taken].chunk_pos;
+		const Ref<HeightMapData> &refine_data = create_queue[taken].refine_data;
+		if (refine_data.is_valid()) {
+			// evicted while queued -> nothing to refine
+			const Ref<HeightMapData> *resident = chunk_table.getptr(chunk_pos);
+			if (resident == nullptr || *resident != refine_data) {
+				continue;
+			}
+			Callable post_refinement = callable_mp(this, &TerrainGenerator::finish_refinement).bind(refine_data, chunk_pos);
+			refine_data->_instantiate_refinement(post_refinement);
+			batch->generated.push_back({ refine_data, Ref<RegionPack>(), chunk_pos, post_refinement });
+			continue;
+		}
+		// left every interest circle while queued
+		if (!in_interest(chunk_pos) && !is_pinned(chunk_pos)) {
+			create_tasks.erase(chunk_pos);
+			burst_chunks.erase(chunk_pos);
+			continue;
+		}
+		Ref<HeightMapData> hmap_data = take_height_map_data(chunk_pos);
+		Callable post_generation = callable_mp(this, &TerrainGenerator::finish_chunk).bind(hmap_data, chunk_pos);
+		Ref<RegionPack> region_pack = find_region_pack(chunk_pos);
+
+		if (region_pack.is_valid()) {
+			batch->baked.push_back({ hmap_data, region_pack, chunk_pos, post_generation });
+			continue;
+		}
+		hmap_data->_instantiate(chunk_pos, post_generation, is_progressive() && !needs_final_heights(chunk_pos));
+		batch->generated.push_back({ hmap_data, Ref<RegionPack>(), chunk_pos, post_generation });
+	}
+	for (uint32_t i = taken; i < create_queue.size(); i++) {
+		create_queue[i - taken] = create_queue[i];
+	}
+	create_queue.resize(create_queue.size() - taken);
+
+	if (batch->size() == 0) {
+		memdelete(batch);
+		return;
+	}
+	const uint32_t tile_count = HeightMapData::get_tile_count();
+	batch->group_id = WorkerThreadPool::get_singleton()->add_template_group_task(
+		batch, &GenerationBatch::generate_element, tile_count, batch->get_element_count(tile_count), -1, true, "TerrainGenerator generation batch"
 	);
+	for (const GenerationBatch::Entry &entry : batch->baked) {
+		create_tasks[entry.chunk_pos] = batch->group_id;
+	}
+	for (const GenerationBatch::Entry &entry : batch->generated) {
+		// refinement passes belong to resident chunks -> not creation tasks
+		if (!chunk_table.has(entry.chunk_pos)) {
+			create_tasks[entry.chunk_pos] = batch->group_id;
+		}
+	}
+	generation_batches.push_back(batch);
+	DEBUG_PRINT_OFTEN("DISPATCH BATCH", batch->size(), "CHUNKS", batch->get_element_count(tile_count), "ELEMENTS");
+}
+
+void TerrainGenerator::wait_generation_batches() {
+	for (GenerationBatch *batch : generation_batches) {
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(batch->group_id);
+		memdelete(batch);
+	}
+	generation_batches.clear();
+}
+
+/*
+* CALLED FROM : dispatch_generation_batches() (group task element)
+*/
+void TerrainGenerator::GenerationBatch::generate_element(uint32_t p_index, uint32_t p_tile_count) {
+	if (p_index < baked.size()) {
+		TERRAIN_TRACE_SCOPE("read_baked_chunk");
+		Entry &entry = baked[p_index];
+		// baked chunks skip noise entirely -> fall back to generation on this worker if the read fails
+		Vector<uint8_t> baked_data;
+		if (entry.region_pack->read_chunk(entry.chunk_pos, baked_data)) {
+			entry.hmap_data->_instantiate_from_data(entry.chunk_pos, baked_data, entry.post_generation);
+			return;
+		}
+		entry.hmap_data->_instantiate(entry.chunk_pos, entry.post_generation);
+		for (uint32_t t = 0; t < p_tile_count; t++) {
+			entry.hmap_data->generate_tile(t);
+		}
+		return;
+	}
+	p_index -= baked.size();
+	generated[p_index / p_tile_count].hmap_data->generate_tile(p_index % p_tile_count);
+}
+
+/*
+* CALLED FROM : HeightMapData (worker that finished the last tile)
+* per-chunk work that only needs the finished heights stays off the main thread
+*/
+void TerrainGenerator::finish_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos) {
+	TERRAIN_TRACE_SCOPE("finish_chunk");
+	// coarse chunks scatter after refinement -> instances would float over interpolated heights
+	// always placed on the generated heights, deformation is composed later on the main thread
+	Ref<ScatterData> scatter_data = hmap_data->get_scatter_data();
+	if (scatter_data.is_valid() && WorldData::SCATTER_MESH.is_valid() && hmap_data->is_refined()) {
+		scatter_data->generate(hmap_data.ptr());
+	}
+	else if (scatter_data.is_valid()) {
+		scatter_data->clear();
+	}
+	MutexLock lock(ready_mutex);
+	ready_chunks.push_back({ hmap_data, chunk_pos });
+}
+
+/*
+* CALLED FROM : HeightMapData (worker that finished the last refinement tile)
+* scattered against the refined heights before the swap -> apply_refinement() only uploads
+*/
+void TerrainGenerator::finish_refinement(Ref<HeightMapData> hmap_data, Vector3 chunk_pos) {
+	TERRAIN_TRACE_SCOPE("finish_refinement");
+	Ref<ScatterData> scatter_data = hmap_data->get_scatter_data();
+	if (scatter_data.is_valid() && WorldData::SCATTER_MESH.is_valid()) {
+		scatter_data->generate(hmap_data.ptr());
+	}
+	MutexLock lock(ready_mutex);
+	ready_chunks.push_back({ hmap_data, chunk_pos, 0.0, true });
 }
-void TerrainGenerator::add_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos, Vector2i grid_pos) {
-	WorkerThreadPool::get_singleton()->wait_for_task_completion(create_tasks[chunk_pos]);
 
+/*
+* CALLED FROM : _process()
+* bursts of finished chunks (teleports) are spread over several frames -> nearest chunks first
+*/
+void TerrainGenerator::integrate_ready_chunks() {
+	TERRAIN_TRACE_SCOPE("integrate_ready_chunks");
+	{
+		MutexLock lock(ready_mutex);
+		for (ReadyChunk &r : ready_chunks) {
+			pending_chunks.push_back(r);
+		}
+		ready_chunks.clear();
+	}
+	if (pending_chunks.is_empty()) {
+		return;
+	}
+	for (ReadyChunk &r : pending_chunks) {
+		r.distance = get_priority(r.chunk_pos);
+	}
+	pending_chunks.sort();
+
+	const uint64_t start = OS::get_singleton()->get_ticks_usec();
+	uint32_t integrated = 0;
+	while (integrated < pending_chunks.size()) {
+		const ReadyChunk &r = pending_chunks[integrated++];
+		if (r.refinement) {
+			apply_refinement(r.hmap_data, r.chunk_pos);
+		}
+		else {
+			add_chunk(r.hmap_data, r.chunk_pos);
+			burst_chunks.erase(r.chunk_pos);
+		}
+		// burst chunks ignore the budget -> startup frame time is traded for a complete first view
+		if (burst_chunks.is_empty() && OS::get_singleton()->get_ticks_usec() - start >= integration_budget_usec) {
+			break;
+		}
+	}
+	// carry the rest over to the next frame
+	for (uint32_t i = integrated; i < pending_chunks.size(); i++) {
+		pending_chunks[i - integrated] = pending_chunks[i];
+	}
+	pending_chunks.resize(pending_chunks.size() - integrated);
+	if (!pending_chunks.is_empty()) {
+		DEBUG_PRINT_OFTEN("CHUNKS CARRIED OVER", pending_chunks.size());
+	}
+}
+
+void TerrainGenerator::add_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos) {
+	TERRAIN_TRACE_SCOPE("add_chunk");
+	scatter_missing(hmap_data);
+	// edits made while the chunk was away/generating -> composed before first upload
+	deformation.compose(hmap_data, chunk_pos);
 	chunk_table[chunk_pos] = hmap_data;
-	lod_meshes[grid_pos]->update(hmap_data->get_image(), chunk_pos);
+	place_chunk(hmap_data, chunk_pos);
+	if (hmap_data->get_scatter_data().is_valid() && hmap_data->is_refined()) {
+		hmap_data->get_scatter_data()->update();
+	}
 	create_tasks.erase(chunk_pos);
-	
-	// run next create task if it exists -> continue call chain
-	if (create_queue.empty()) {
+	if (!hmap_data->is_refined()) {
+		create_queue.push_back({ chunk_pos, 0.0, hmap_data });
+		return;
+	}
+	queue_navigation(hmap_data, chunk_pos);
+	if (navigation_enabled) {
+		navigation.queue_neighbours(chunk_table, chunk_pos);
+	}
+}
+
+/*
+* CALLED FROM : integrate_ready_chunks()
+* evicted meanwhile -> the chunk was not recycled (delete_far_away_chunks), so it is simply dropped here
+*/
+void TerrainGenerator::apply_refinement(const Ref<HeightMapData> &hmap_data, const Vector3 &chunk_pos) {
+	TERRAIN_TRACE_SCOPE("apply_refinement");
+	const Ref<HeightMapData> *resident = chunk_table.getptr(chunk_pos);
+	if (resident == nullptr || *resident != hmap_data) {
+		return;
+	}
+	hmap_data->apply_refinement();
+	scatter_missing(hmap_data);
+	deformation.compose(hmap_data, chunk_pos);
+	place_chunk(hmap_data, chunk_pos, true);
+	if (hmap_data->get_scatter_data().is_valid()) {
+		hmap_data->get_scatter_data()->update();
+	}
+	// patches that skipped this chunk pick up the final heights
+	const Vector3 start = hmap_data->get_start_pos();
+	const Rect2 rect(start.x, start.z, WorldData::LENGTH, WorldData::LENGTH);
+	collision_dirty_rect = collision_dirty ? collision_dirty_rect.merge(rect) : rect;
+	collision_dirty = true;
+	queue_navigation(hmap_data, chunk_pos);
+	if (navigation_enabled) {
+		navigation.queue_neighbours(chunk_table, chunk_pos);
+	}
+}
+
+/*
+* CALLED FROM : add_chunk() apply_refinement() before deformation is composed, same heights as the workers scatter on
+* finished while the scatter mesh was unset -> only chunks in flight across set_scatter_mesh() scatter here
+*/
+void TerrainGenerator::scatter_missing(const Ref<HeightMapData> &hmap_data) {
+	if (!needs_scatter(hmap_data)) {
+		return;
+	}
+	if (hmap_data->get_scatter_data().is_null()) {
+		hmap_data->set_scatter_data(memnew(ScatterData));
+	}
+	hmap_data->get_scatter_data()->generate(hmap_data.ptr());
+}
+
+/*
+* CALLED FROM : add_chunk() apply_refinement() update_navigation()
+* coarse chunks are skipped -> their tile is baked once the refined heights are swapped in
+*/
+void TerrainGenerator::queue_navigation(const Ref<HeightMapData> &hmap_data, const Vector3 &chunk_pos) {
+	if (!navigation_enabled || !hmap_data->is_refined() || !in_navigation_radius(chunk_pos)) {
+		return;
+	}
+	navigation.queue_bake(chunk_table, hmap_data, chunk_pos);
+}
+
+/*
+* CALLED FROM : _process()
+*/
+void TerrainGenerator::update_navigation() {
+	if (!navigation_enabled) {
 		return;
-	}	
-	create_queue.front().call_deferred();
-	create_queue.pop();
+	}
+	TERRAIN_TRACE_SCOPE("update_navigation");
+	if (navigation_scan) {
+		for (const KeyValue<Vector3, Ref<HeightMapData>> &c : chunk_table) {
+			// left the radius but still resident -> the region would otherwise stay registered until eviction
+			if (!in_navigation_radius(c.key)) {
+				navigation.release(c.key);
+			}
+			else if (!navigation.has_tile(c.key)) {
+				queue_navigation(c.value, c.key);
+			}
+		}
+		navigation_scan = false;
+	}
+	navigation.update([this](const Vector3 &chunk_pos) { return get_priority(chunk_pos); });
+}
+
+void TerrainGenerator::set_navigation_enabled(const bool &p_enabled) {
+	if (navigation_enabled == p_enabled) return;
+	navigation_enabled = p_enabled;
+	if (!navigation_enabled) {
+		navigation.clear();
+	}
+	navigation_scan = true;
+}
+
+/*
+* CALLED FROM : add_chunk() flush_dirty_chunks()
+* grid slot is resolved now -> observers may have moved since the chunk was queued
+*/
+void TerrainGenerator::place_chunk(const Ref<HeightMapData> &hmap_data, const Vector3 &chunk_pos, bool p_refresh_only) {
+	for (Observer &o : observers) {
+		Vector3 grid = chunk_pos - o.chunk;
+		auto mesh_itr = o.lod_meshes.find(Vector2i(grid.x, grid.z));
+		if (mesh_itr == o.lod_meshes.end()) {
+			continue;
+		}
+		if (p_refresh_only && mesh_itr->value->get_chunk_pos() != chunk_pos) {
+			continue;
+		}
+		mesh_itr->value->update(hmap_data->get_image(), chunk_pos);
+	}
 }
+
 void TerrainGenerator::delete_far_away_chunks() {
-	// Also take the opportunity to delete far away chunks.
+	TERRAIN_TRACE_SCOPE("delete_far_away_chunks");
+	// Also take the opportunity to delete far away chunks -> only once outside every observer's circle
+	Vector<Vector3> far_away;
+	const int margin = server_mode ? server_eviction_margin : 0;
 	for (auto c : chunk_table) {
-		if (player_chunk.distance_to(c.key) < render_distance) {
+		if (in_interest(c.key, margin) || is_pinned(c.key)) {
 			continue;
 		}
-		reuse_pool.write(c.value);
-		chunk_table.erase(c.key);
+		far_away.push_back(c.key);
+	}
+	for (const Vector3 &chunk_pos : far_away) {
+		Ref<HeightMapData> hmap_data = chunk_table[chunk_pos];
+		// scatter instances are recycled with the chunk -> hide until regenerated
+		if (hmap_data->get_scatter_data().is_valid()) {
+			hmap_data->get_scatter_data()->set_visiblity(false);
+		}
+		// a refinement pass may still be writing into it -> not recycled, freed with its last reference
+		if (hmap_data->is_refined()) {
+			reuse_pool.write(hmap_data);
+		}
+		navigation.release(chunk_pos);
+		chunk_table.erase(chunk_pos);
 	}
 }
 
@@ -333,29 +944,372 @@ void TerrainGenerator::delete_far_away_chunks() {
 void TerrainGenerator::set_player_node_path(const NodePath &p_path) {
 	if (_player_node_path == p_path) return;
 	_player_node_path = p_path;
+	observers[0].node_path = p_path;
 	setter_process(_player_node_path.is_empty(), "PLAYER");
 }
+void TerrainGenerator::set_player_layer_mask(const int &p_layer_mask) {
+	if (observers[0].layer_mask == uint32_t(p_layer_mask)) return;
+	observers[0].layer_mask = p_layer_mask;
+	if (!ready_queued.load()) {
+		build_lod_ring(observers[0]);
+		build_horizon();
+	}
+}
+
+/*
+* extra observers share chunk_table, create_tasks and the generation batches with the player
+* p_layer_mask -> render layers of the observer's viewport (cull mask), 0 keeps chunks resident without a ring
+*/
+bool TerrainGenerator::add_observer(const NodePath &p_path, const int &p_layer_mask, const bool &p_collision) {
+	ERR_FAIL_COND_V_MSG(p_path.is_empty(), false, "Observer node path is empty.");
+	for (const Observer &o : observers) {
+		if (o.node_path == p_path) return false;
+	}
+	Observer observer;
+	observer.node_path = p_path;
+	observer.layer_mask = p_layer_mask;
+	observer.has_collision = p_collision;
+	observers.push_back(observer);
+	// before _ready the ring and collision are built with the others
+	if (!ready_queued.load()) {
+		build_lod_ring(observers[observers.size() - 1]);
+		build_collision(observers[observers.size() - 1]);
+	}
+	DEBUG_PRINT_RARE("ADD OBSERVER", p_path, observers.size());
+	return true;
+}
+bool TerrainGenerator::remove_observer(const NodePath &p_path) {
+	// observer 0 is the player -> cleared through set_player_node_path
+	for (uint32_t i = 1; i < observers.size(); i++) {
+		if (observers[i].node_path != p_path) continue;
+		clear_lod_ring(observers[i]);
+		clear_collision(observers[i]);
+		observers.remove_at(i);
+		if (!ready_queued.load()) {
+			delete_far_away_chunks();
+		}
+		DEBUG_PRINT_RARE("REMOVE OBSERVER", p_path, observers.size());
+		return true;
+	}
+	return false;
+}
 void TerrainGenerator::set_terrain_shader(Ref<Shader> p_shader) {
 	if (WorldData::terrain_shader == p_shader) return;
 	WorldData::terrain_shader = p_shader;
 	setter_process(WorldData::terrain_shader.is_null(), "SHADER");
 }
+// chunks of the old source are dropped -> everything is generated again from the new one
+void TerrainGenerator::set_height_source(const Ref<HeightSource> &p_source) {
+	if (WorldData::height_source == p_source) return;
+	const Callable on_changed = callable_mp(this, &TerrainGenerator::height_source_changed);
+	if (WorldData::height_source.is_valid()) {
+		WorldData::height_source->disconnect_changed(on_changed);
+	}
+	WorldData::height_source = p_source;
+	if (p_source.is_valid()) {
+		p_source->connect_changed(on_changed);
+	}
+	height_source_changed();
+}
+// also connected to the source's `changed` -> inspector edits regenerate instead of mixing old and new heights
+void TerrainGenerator::height_source_changed() {
+	if (is_inside_tree() && is_node_ready()) {
+		_exit_tree();
+		setter_process(false, "HEIGHT SOURCE");
+	}
+}
 void TerrainGenerator::set_terrain_offset(const Vector3 &p_pos) {
 	if (WorldData::WORLD_OFFSET == p_pos) return;
 	WorldData::WORLD_OFFSET = p_pos;
-	for (auto m : lod_meshes) {
-		m.value->update_position();
+	for (Observer &o : observers) {
+		for (auto m : o.lod_meshes) {
+			m.value->update_position();
+		}
 	}
 }
 void TerrainGenerator::set_terrain_amplitude(const real_t &new_amp) {
 	if (WorldData::AMPLITUDE == new_amp) return;
 	WorldData::AMPLITUDE = new_amp;
+	if (server_mode) return;
 	RS::get_singleton()->global_shader_parameter_set("amplitude", new_amp);
+	update_horizon_sink();
 }
 void TerrainGenerator::set_terrain_height_exp(const real_t &new_height_exp) {
 	if (WorldData::HEIGHT_EXP == new_height_exp) return;
 	WorldData::HEIGHT_EXP = new_height_exp;
+	if (server_mode) return;
 	RS::get_singleton()->global_shader_parameter_set("height_exp", new_height_exp);
+	update_horizon_sink();
+}
+
+/*
+* CALLED FROM : _ready() set_horizon_enabled() set_player_layer_mask()
+* inner radius -> chunk centers are within render_distance, so one chunk less is fully covered
+*/
+void TerrainGenerator::build_horizon() {
+	horizon.unref();
+	if (!horizon_enabled || horizon_shader.is_null() || server_mode || observers[0].layer_mask == 0) {
+		return;
+	}
+	const real_t inner_radius = MAX(render_distance - 1, 0) * WorldData::LENGTH;
+	const real_t span = horizon_scale * 2.0 * render_distance * WorldData::LENGTH;
+	horizon.instantiate(horizon_shader, span, inner_radius, horizon_resolution, horizon_octaves);
+	horizon->set_layer_mask(observers[0].layer_mask);
+	update_horizon_sink();
+	DEBUG_PRINT_RARE("HORIZON", span, horizon_resolution, horizon_octaves);
+}
+
+// coarse heights can differ from the chunks by a share of the height range -> follows amplitude/height_exp
+void TerrainGenerator::update_horizon_sink() {
+	if (horizon.is_null()) {
+		return;
+	}
+	const real_t height_range = HeightMapData::true_height(1.0) - HeightMapData::true_height(0.0);
+	horizon->set_sink_depth(MAX(HORIZON_SINK_FRACTION * height_range, (real_t)4.0));
+}
+
+void TerrainGenerator::set_horizon_enabled(const bool &p_enabled) {
+	if (horizon_enabled == p_enabled) return;
+	horizon_enabled = p_enabled;
+	if (!ready_queued.load()) {
+		build_horizon();
+	}
+}
+void TerrainGenerator::set_horizon_shader(const Ref<Shader> &p_shader) {
+	if (horizon_shader == p_shader) return;
+	horizon_shader = p_shader;
+	if (!ready_queued.load()) {
+		build_horizon();
+	}
+}
+
+/*
+* every chunk overlapping the square around p_position is pinned and queued ahead of observer chunks
+* p_collision -> the request owns a collision patch over the square (at least collision_size), built once heights are resident
+*/
+Ref<TerrainRequest> TerrainGenerator::request_region(const Vector3 &p_position, const real_t &p_radius, const bool &p_collision) {
+	ERR_FAIL_COND_V_MSG(p_radius < 0.0, Ref<TerrainRequest>(), "Terrain request radius cannot be negative.");
+	Ref<TerrainRequest> request;
+	request.instantiate();
+	request->position = p_position;
+	request->radius = p_radius;
+	request->collision = p_collision;
+
+	PendingRequest pending;
+	pending.request = request;
+	real_t extent = p_radius;
+	if (p_collision) {
+		// the patch is capped -> it never shrinks the pinned square below the radius
+		extent = MAX(p_radius, get_request_quads(p_radius) * WorldData::STEP_SIZE / 2.0);
+	}
+	const Vector3 begin = chunk_containing(p_position - Vector3(extent, 0, extent));
+	const Vector3 end = chunk_containing(p_position + Vector3(extent, 0, extent));
+	for (int z = begin.z; z <= end.z; z++) {
+		for (int x = begin.x; x <= end.x; x++) {
+			const Vector3 chunk_pos(x, 0, z);
+			pending.chunks.push_back(chunk_pos);
+			pinned_chunks[chunk_pos]++;
+			if (!chunk_table.has(chunk_pos) && !create_tasks.has(chunk_pos)) {
+				create_tasks[chunk_pos] = WorkerThreadPool::INVALID_TASK_ID;
+				create_queue.push_back({ chunk_pos });
+			}
+		}
+	}
+	requests.push_back(pending);
+	DEBUG_PRINT_RARE("TERRAIN REQUEST", p_position, p_radius, pending.chunks.size());
+	// already resident -> completes on the next frame, never inside this call
+	return request;
+}
+
+void TerrainGenerator::cancel_request(const Ref<TerrainRequest> &p_request) {
+	for (uint32_t i = 0; i < requests.size(); i++) {
+		if (requests[i].request == p_request) {
+			release_request(i);
+			return;
+		}
+	}
+}
+
+/*
+* CALLED FROM : _process() after integration
+* completion is checked per frame -> chunks may finish in any order, so no per-chunk bookkeeping is needed
+*/
+void TerrainGenerator::update_requests() {
+	LocalVector<Ref<TerrainRequest>> completed;
+	for (uint32_t i = 0; i < requests.size();) {
+		PendingRequest &pending = requests[i];
+		TerrainRequest *request = pending.request.ptr();
+
+		if (request->completed) {
+			// nobody holds the handle anymore -> unpin
+			if (request->get_reference_count() <= 1) {
+				release_request(i);
+				continue;
+			}
+			i++;
+			continue;
+		}
+
+		bool resident = true;
+		for (const Vector3 &chunk_pos : pending.chunks) {
+			if (is_chunk_final(chunk_pos)) {
+				continue;
+			}
+			resident = false;
+			// re-initialized since the request was made
+			if (!chunk_table.has(chunk_pos) && !create_tasks.has(chunk_pos)) {
+				create_tasks[chunk_pos] = WorkerThreadPool::INVALID_TASK_ID;
+				create_queue.push_back({ chunk_pos });
+			}
+		}
+		if (!resident || ready_queued.load()) {
+			i++;
+			continue;
+		}
+
+		if (request->collision) {
+			const int quads = get_request_quads(request->radius);
+			const real_t side = quads * WorldData::STEP_SIZE;
+			create_patch(pending.patch, Size2(side, side), quads - 1);
+			Vector3 origin = request->position.snappedf(WorldData::STEP_SIZE);
+			origin.y = 0.0;
+			pending.patch.collision_map->set_global_position(origin);
+			// grown by a step -> has_point excludes the far edges
+			update_shape_region(pending.patch, get_patch_rect(pending.patch).grow(WorldData::STEP_SIZE));
+			pending.patch.manual_update = false;
+		}
+		request->completed = true;
+		completed.push_back(pending.request);
+		i++;
+	}
+	// signals last -> callbacks may add or cancel requests
+	for (const Ref<TerrainRequest> &request : completed) {
+		DEBUG_PRINT_RARE("TERRAIN REQUEST READY", request->get_position());
+		request->emit_signal(SNAME("completed"));
+		emit_signal(SNAME("region_ready"), request);
+	}
+}
+
+void TerrainGenerator::release_request(uint32_t p_index) {
+	PendingRequest &pending = requests[p_index];
+	free_patch(pending.patch);
+	for (const Vector3 &chunk_pos : pending.chunks) {
+		int *count = pinned_chunks.getptr(chunk_pos);
+		if (count != nullptr && --(*count) <= 0) {
+			pinned_chunks.erase(chunk_pos);
+		}
+	}
+	requests.remove_at(p_index);
+}
+
+/*
+* rendering resources are only created in _ready -> switching rebuilds a running terrain
+* deformation deltas and region packs are kept
+*/
+void TerrainGenerator::set_server_mode(const bool &p_enabled) {
+	if (server_mode == p_enabled) return;
+	server_mode = p_enabled;
+	DEBUG_PRINT_RARE("SERVER MODE", server_mode);
+	if (ready_queued.load() || !is_inside_tree()) return;
+	_exit_tree();
+	ready_queued.store(true);
+	_ready();
+}
+
+/*
+* CALLED FROM : raise_terrain() flatten_terrain()
+* any number of edits per frame -> each dirty chunk is uploaded once in flush_dirty_chunks()
+*/
+void TerrainGenerator::apply_edit(const DeformationLayer::Edit &p_edit) {
+	ERR_FAIL_COND_MSG(p_edit.radius <= 0.0, "Terrain edit radius must be positive.");
+	Rect2 rect = deformation.apply(p_edit, chunk_table, dirty_chunks);
+	collision_dirty_rect = collision_dirty ? collision_dirty_rect.merge(rect) : rect;
+	collision_dirty = true;
+}
+
+/*
+* CALLED FROM : _process()
+* texture uploads are whole-image (RenderingServer has no partial texture_2d_update), but only once per chunk per frame
+*/
+void TerrainGenerator::flush_dirty_chunks() {
+	TERRAIN_TRACE_SCOPE("flush_dirty_chunks");
+	for (const Vector3 &chunk_pos : dirty_chunks) {
+		auto chunk_itr = chunk_table.find(chunk_pos);
+		if (chunk_itr == chunk_table.end()) {
+			continue;
+		}
+		place_chunk(chunk_itr->value, chunk_pos, true);
+		// edited heights -> tile is baked again, the old one stays registered until then
+		if (navigation.has_tile(chunk_pos) && chunk_itr->value->is_refined()) {
+			navigation.queue_bake(chunk_table, chunk_itr->value, chunk_pos);
+		}
+	}
+	dirty_chunks.clear();
+}
+
+/*
+* packs must be baked with the same LENGTH_EXP/STEP_EXP and height source config as the running terrain
+* shards of one region are simply added as separate packs
+*/
+Error TerrainGenerator::add_region_pack(const String &p_path) {
+	Ref<RegionPack> pack;
+	pack.instantiate();
+	Error err = pack->open(p_path);
+	if (err != OK) {
+		return err;
+	}
+	ERR_FAIL_COND_V_MSG(!pack->is_compatible(), ERR_INVALID_DATA, "Region pack was baked with a different resolution or height source: " + p_path);
+	DEBUG_PRINT_RARE("ADD REGION PACK", p_path, pack->get_chunk_count());
+	region_packs.push_back(pack);
+	return OK;
+}
+
+/*
+* scatter mesh is shared by every chunk MultiMesh
+* setting it to null hides all instances
+* setting it scatters resident chunks that finished without a mesh on worker threads -> the rest only re-upload
+*/
+void TerrainGenerator::set_scatter_mesh(const Ref<Mesh> &p_mesh) {
+	if (scatter_mesh == p_mesh) return;
+	scatter_mesh = p_mesh;
+	WorldData::SCATTER_MESH = scatter_mesh.is_valid() ? scatter_mesh->get_rid() : RID();
+	if (scatter_mesh.is_null()) {
+		for (auto &c : chunk_table) {
+			if (c.value->get_scatter_data().is_valid()) {
+				c.value->get_scatter_data()->set_visiblity(false);
+			}
+		}
+		return;
+	}
+
+	LocalVector<HeightMapData *> scatter_chunks;
+	for (auto &c : chunk_table) {
+		if (!needs_scatter(c.value)) {
+			continue;
+		}
+		if (c.value->get_scatter_data().is_null()) {
+			c.value->set_scatter_data(memnew(ScatterData));
+		}
+		scatter_chunks.push_back(c.value.ptr());
+	}
+	if (!scatter_chunks.is_empty()) {
+		WorkerThreadPool::GroupID group_id = WorkerThreadPool::get_singleton()->add_template_group_task(
+			this, &TerrainGenerator::scatter_element, scatter_chunks.ptr(), scatter_chunks.size(), -1, true, "Terrain scatter"
+		);
+		WorkerThreadPool::get_singleton()->wait_for_group_task_completion(group_id);
+	}
+	for (auto &c : chunk_table) {
+		if (c.value->get_scatter_data().is_valid() && c.value->is_refined()) {
+			c.value->get_scatter_data()->update();
+		}
+	}
+}
+
+/*
+* CALLED FROM : set_scatter_mesh() (group task element)
+*/
+void TerrainGenerator::scatter_element(uint32_t p_index, HeightMapData **p_chunks) {
+	p_chunks[p_index]->get_scatter_data()->generate(p_chunks[p_index]);
 }
 
 // properties are exposed in gdscript
@@ -365,17 +1319,124 @@ void TerrainGenerator::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_step_size", "new_step_exp"), &TerrainGenerator::set_step_size);
 	ClassDB::bind_method(D_METHOD("set_length", "new_length_exp"), &TerrainGenerator::set_length);
 	ClassDB::bind_method(D_METHOD("set_seed", "new_seed"), &TerrainGenerator::set_seed);
+	ClassDB::bind_method(D_METHOD("set_tile_size", "p_tile_size"), &TerrainGenerator::set_tile_size);
+	ClassDB::bind_method(D_METHOD("get_tile_size"), &TerrainGenerator::get_tile_size);
+	ClassDB::bind_method(D_METHOD("set_integration_budget_usec", "p_usec"), &TerrainGenerator::set_integration_budget_usec);
+	ClassDB::bind_method(D_METHOD("get_integration_budget_usec"), &TerrainGenerator::get_integration_budget_usec);
+	ClassDB::bind_method(D_METHOD("set_initial_burst_radius", "p_radius"), &TerrainGenerator::set_initial_burst_radius);
+	ClassDB::bind_method(D_METHOD("get_initial_burst_radius"), &TerrainGenerator::get_initial_burst_radius);
+	ClassDB::bind_method(D_METHOD("set_progressive_refinement", "p_enabled"), &TerrainGenerator::set_progressive_refinement);
+	ClassDB::bind_method(D_METHOD("is_progressive_refinement"), &TerrainGenerator::is_progressive_refinement);
+
+	// NAVIGATION
+	ClassDB::bind_method(D_METHOD("set_navigation_enabled", "p_enabled"), &TerrainGenerator::set_navigation_enabled);
+	ClassDB::bind_method(D_METHOD("is_navigation_enabled"), &TerrainGenerator::is_navigation_enabled);
+	ClassDB::bind_method(D_METHOD("set_navigation_radius", "p_radius"), &TerrainGenerator::set_navigation_radius);
+	ClassDB::bind_method(D_METHOD("get_navigation_radius"), &TerrainGenerator::get_navigation_radius);
+	ClassDB::bind_method(D_METHOD("set_navigation_mesh", "p_navigation_mesh"), &TerrainGenerator::set_navigation_mesh);
+	ClassDB::bind_method(D_METHOD("get_navigation_mesh"), &TerrainGenerator::get_navigation_mesh);
+	ClassDB::bind_method(D_METHOD("set_navigation_layers", "p_layers"), &TerrainGenerator::set_navigation_layers);
+	ClassDB::bind_method(D_METHOD("get_navigation_layers"), &TerrainGenerator::get_navigation_layers);
+	ClassDB::bind_method(D_METHOD("set_navigation_sample_step", "p_step"), &TerrainGenerator::set_navigation_sample_step);
+	ClassDB::bind_method(D_METHOD("get_navigation_sample_step"), &TerrainGenerator::get_navigation_sample_step);
+	ClassDB::bind_method(D_METHOD("get_navigation_tile_count"), &TerrainGenerator::get_navigation_tile_count);
 
 	// PARAMETERS (DYNAMIC)
 	ClassDB::bind_method(D_METHOD("set_player_node_path", "p_path"), &TerrainGenerator::set_player_node_path);
+	ClassDB::bind_method(D_METHOD("set_player_layer_mask", "p_layer_mask"), &TerrainGenerator::set_player_layer_mask);
 	ClassDB::bind_method(D_METHOD("set_terrain_shader", "p_shader"), &TerrainGenerator::set_terrain_shader);
+	ClassDB::bind_method(D_METHOD("set_height_source", "p_source"), &TerrainGenerator::set_height_source);
 	ClassDB::bind_method(D_METHOD("set_terrain_offset", "p_pos"), &TerrainGenerator::set_terrain_offset);
 	ClassDB::bind_method(D_METHOD("set_terrain_amplitude", "new_amp"), &TerrainGenerator::set_terrain_amplitude);
 	ClassDB::bind_method(D_METHOD("set_terrain_height_exp", "new_height_exp"), &TerrainGenerator::set_terrain_height_exp);
 
 	ClassDB::bind_method(D_METHOD("get_player_node_path"), &TerrainGenerator::get_player_node_path);
+	ClassDB::bind_method(D_METHOD("get_player_layer_mask"), &TerrainGenerator::get_player_layer_mask);
 	ClassDB::bind_method(D_METHOD("get_terrain_shader"), &TerrainGenerator::get_terrain_shader);
+	ClassDB::bind_method(D_METHOD("get_height_source"), &TerrainGenerator::get_height_source);
 	ClassDB::bind_method(D_METHOD("get_terrain_offset"), &TerrainGenerator::get_terrain_offset);
 	ClassDB::bind_method(D_METHOD("get_terrain_amplitude"), &TerrainGenerator::get_terrain_amplitude);
 	ClassDB::bind_method(D_METHOD("get_terrain_height_exp"), &TerrainGenerator::get_terrain_height_exp);
+
+	// SERVER MODE
+	ClassDB::bind_method(D_METHOD("set_server_mode", "p_enabled"), &TerrainGenerator::set_server_mode);
+	ClassDB::bind_method(D_METHOD("is_server_mode"), &TerrainGenerator::is_server_mode);
+	ClassDB::bind_method(D_METHOD("set_server_radius", "p_radius"), &TerrainGenerator::set_server_radius);
+	ClassDB::bind_method(D_METHOD("get_server_radius"), &TerrainGenerator::get_server_radius);
+	ClassDB::bind_method(D_METHOD("set_server_eviction_margin", "p_margin"), &TerrainGenerator::set_server_eviction_margin);
+	ClassDB::bind_method(D_METHOD("get_server_eviction_margin"), &TerrainGenerator::get_server_eviction_margin);
+
+	// HEIGHT QUERIES
+	ClassDB::bind_method(D_METHOD("is_position_resident", "p_position"), &TerrainGenerator::is_position_resident);
+	ClassDB::bind_method(D_METHOD("get_height_at", "p_position"), &TerrainGenerator::get_height_at);
+	ClassDB::bind_method(D_METHOD("get_normal_at", "p_position"), &TerrainGenerator::get_normal_at);
+
+	// OBSERVERS
+	ClassDB::bind_method(D_METHOD("add_observer", "p_path", "p_layer_mask", "p_collision"), &TerrainGenerator::add_observer, DEFVAL(0), DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("remove_observer", "p_path"), &TerrainGenerator::remove_observer);
+	ClassDB::bind_method(D_METHOD("get_observer_count"), &TerrainGenerator::get_observer_count);
+
+	// VEGETATION SCATTER
+	ClassDB::bind_method(D_METHOD("set_scatter_mesh", "p_mesh"), &TerrainGenerator::set_scatter_mesh);
+	ClassDB::bind_method(D_METHOD("set_scatter_spacing", "p_spacing"), &TerrainGenerator::set_scatter_spacing);
+	ClassDB::bind_method(D_METHOD("set_scatter_density", "p_density"), &TerrainGenerator::set_scatter_density);
+	ClassDB::bind_method(D_METHOD("set_scatter_height_range", "p_range"), &TerrainGenerator::set_scatter_height_range);
+	ClassDB::bind_method(D_METHOD("set_scatter_max_slope", "p_slope"), &TerrainGenerator::set_scatter_max_slope);
+	ClassDB::bind_method(D_METHOD("set_scatter_scale_range", "p_range"), &TerrainGenerator::set_scatter_scale_range);
+
+	ClassDB::bind_method(D_METHOD("get_scatter_mesh"), &TerrainGenerator::get_scatter_mesh);
+	ClassDB::bind_method(D_METHOD("get_scatter_spacing"), &TerrainGenerator::get_scatter_spacing);
+	ClassDB::bind_method(D_METHOD("get_scatter_density"), &TerrainGenerator::get_scatter_density);
+	ClassDB::bind_method(D_METHOD("get_scatter_height_range"), &TerrainGenerator::get_scatter_height_range);
+	ClassDB::bind_method(D_METHOD("get_scatter_max_slope"), &TerrainGenerator::get_scatter_max_slope);
+	ClassDB::bind_method(D_METHOD("get_scatter_scale_range"), &TerrainGenerator::get_scatter_scale_range);
+
+	// DEFORMATION
+	ClassDB::bind_method(D_METHOD("raise_terrain", "p_center", "p_radius", "p_amount"), &TerrainGenerator::raise_terrain);
+	ClassDB::bind_method(D_METHOD("flatten_terrain", "p_center", "p_radius", "p_height"), &TerrainGenerator::flatten_terrain);
+	ClassDB::bind_method(D_METHOD("get_deformed_chunk_count"), &TerrainGenerator::get_deformed_chunk_count);
+
+	// STREAMING STATS
+	ClassDB::bind_method(D_METHOD("get_missing_chunk_count"), &TerrainGenerator::get_missing_chunk_count);
+	ClassDB::bind_method(D_METHOD("get_queued_chunk_count"), &TerrainGenerator::get_queued_chunk_count);
+
+	// FAR-FIELD HORIZON
+	ClassDB::bind_method(D_METHOD("set_horizon_enabled", "p_enabled"), &TerrainGenerator::set_horizon_enabled);
+	ClassDB::bind_method(D_METHOD("set_horizon_shader", "p_shader"), &TerrainGenerator::set_horizon_shader);
+	ClassDB::bind_method(D_METHOD("set_horizon_scale", "p_scale"), &TerrainGenerator::set_horizon_scale);
+	ClassDB::bind_method(D_METHOD("set_horizon_resolution", "p_resolution"), &TerrainGenerator::set_horizon_resolution);
+	ClassDB::bind_method(D_METHOD("set_horizon_octaves", "p_octaves"), &TerrainGenerator::set_horizon_octaves);
+	ClassDB::bind_method(D_METHOD("is_horizon_enabled"), &TerrainGenerator::is_horizon_enabled);
+	ClassDB::bind_method(D_METHOD("get_horizon_shader"), &TerrainGenerator::get_horizon_shader);
+	ClassDB::bind_method(D_METHOD("get_horizon_scale"), &TerrainGenerator::get_horizon_scale);
+	ClassDB::bind_method(D_METHOD("get_horizon_resolution"), &TerrainGenerator::get_horizon_resolution);
+	ClassDB::bind_method(D_METHOD("get_horizon_octaves"), &TerrainGenerator::get_horizon_octaves);
+
+	// TERRAIN REQUESTS
+	ClassDB::bind_method(D_METHOD("request_region", "p_position", "p_radius", "p_collision"), &TerrainGenerator::request_region, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("cancel_request", "p_request"), &TerrainGenerator::cancel_request);
+	ClassDB::bind_method(D_METHOD("get_request_count"), &TerrainGenerator::get_request_count);
+	ADD_SIGNAL(MethodInfo("region_ready", PropertyInfo(Variant::OBJECT, "request", PROPERTY_HINT_RESOURCE_TYPE, "TerrainRequest")));
+
+	// PIPELINE TRACE
+	ClassDB::bind_method(D_METHOD("set_trace_enabled", "p_enabled"), &TerrainGenerator::set_trace_enabled);
+	ClassDB::bind_method(D_METHOD("is_trace_enabled"), &TerrainGenerator::is_trace_enabled);
+	ClassDB::bind_method(D_METHOD("clear_trace"), &TerrainGenerator::clear_trace);
+	ClassDB::bind_method(D_METHOD("get_trace_json"), &TerrainGenerator::get_trace_json);
+	ClassDB::bind_method(D_METHOD("save_trace", "p_file"), &TerrainGenerator::save_trace);
+
+	// BAKED REGIONS
+	ClassDB::bind_method(D_METHOD("add_region_pack", "p_path"), &TerrainGenerator::add_region_pack);
+	ClassDB::bind_method(D_METHOD("clear_region_packs"), &TerrainGenerator::clear_region_packs);
+	ClassDB::bind_method(D_METHOD("get_region_pack_count"), &TerrainGenerator::get_region_pack_count);
+	ClassDB::bind_method(D_METHOD("bake_region", "p_path", "p_region", "p_fast_compression", "p_shard", "p_shard_count"), &TerrainGenerator::bake_region, DEFVAL(false), DEFVAL(0), DEFVAL(1));
+}
+
+void TerrainRequest::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("get_position"), &TerrainRequest::get_position);
+	ClassDB::bind_method(D_METHOD("get_radius"), &TerrainRequest::get_radius);
+	ClassDB::bind_method(D_METHOD("has_collision"), &TerrainRequest::has_collision);
+	ClassDB::bind_method(D_METHOD("is_completed"), &TerrainRequest::is_completed);
+
+	ADD_SIGNAL(MethodInfo("completed"));
 }
\ No newline at end of file
@@ -5,9 +5,39 @@
 #include "scene/3d/physics/collision_shape_3d.h"
 #include "scene/resources/3d/concave_polygon_shape_3d.h"
 #include "height_map_data.h"
+#include "region_pack.h"
+#include "deformation_layer.h"
+#include "horizon_data.h"
+#include "navigation_layer.h"
+
+#include "core/os/os.h"
 
 #include <chrono>
 
+/*
+* handle for request_region() -> await request.completed
+* holding the handle keeps the region (and its collision) resident after completion
+*/
+class TerrainRequest : public RefCounted {
+	GDCLASS(TerrainRequest, RefCounted);
+	friend class TerrainGenerator;
+
+	Vector3 position;
+	real_t radius = 0.0;
+	bool collision = false;
+	bool completed = false;
+
+protected:
+	static void _bind_methods();
+
+public:
+	Vector3 get_position() const { return position; }
+	real_t get_radius() const { return radius; }
+	bool has_collision() const { return collision; }
+	bool is_completed() const { return completed; }
+};
+
+
 class TerrainGenerator : public Node3D {
 	GDCLASS(TerrainGenerator, Node3D);
 	
@@ -19,27 +49,49 @@ protected:
 	NodePath _player_node_path;
 
 	/*
-	* COLLISION MAPPING MEMBERS
+	* SERVER MODE -> no MeshData, materials, textures, scatter or shader globals
+	* only height buffers, collision around observers and the height queries are kept
+	*/
+	bool server_mode = false;
+	// chunks kept around each observer in server mode -> collision and queries rarely need more
+	int server_radius = 2;
+	// extra chunks before eviction in server mode -> players pacing on a chunk border do not thrash
+	int server_eviction_margin = 1;
+	int get_interest_radius() const { return server_mode ? server_radius : render_distance; }
+
+	/*
+	* COLLISION MAPPING MEMBERS -> one patch per observer with collision enabled
+	* godot managed, do not make direct memory modifications
 	*/
-	bool _manual_collision_update = false;
+	struct CollisionPatch {
+		bool manual_update = false;
+		Size2 size;
+		Vector<Vector3> shape_faces;
+		StaticBody3D *static_body_3d = nullptr;
+		CollisionShape3D *collision_map = nullptr;
+		Ref<ConcavePolygonShape3D> collision_shape;
+	};
 	Size2 collision_size = {32, 32};
-	Vector<Vector3> shape_faces;
-	StaticBody3D* static_body_3d = nullptr;
-	CollisionShape3D* collision_map = nullptr;
-	Ref<ConcavePolygonShape3D> collision_shape;
-	void update_shape(int x, int z);
-
-	std::queue<Callable> create_queue;
-	bool update_check() {
-		Vector3 new_pos = calculate_player_chunk();
-		bool should_update = false;
-		for (const auto &m : lod_meshes) {
-			Vector3 chunk_pos = new_pos + Vector3(m.key.x, 0, m.key.y);
-			if (( should_update = !chunk_table.has(chunk_pos) )) break;
-		}
-		return should_update;
+	void create_patch(CollisionPatch &r_patch, const Size2 &p_size, int p_subdivisions);
+	void free_patch(CollisionPatch &r_patch);
+	// only vertices inside p_rect (world xz) are re-sampled
+	void update_shape_region(CollisionPatch &r_patch, const Rect2 &p_rect);
+	Rect2 get_patch_rect(const CollisionPatch &p_patch) const {
+		const Vector3 origin = p_patch.collision_map->get_global_position();
+		return Rect2(origin.x - p_patch.size.x / 2.0, origin.z - p_patch.size.y / 2.0, p_patch.size.x, p_patch.size.y);
 	}
-	void push_create_task(Vector3 chunk_pos, Vector2i grid_pos) {
+
+	/*
+	* DEFORMATION -> edits are applied in place, uploads and collision are coalesced per frame/tick
+	*/
+	DeformationLayer deformation;
+	HashSet<Vector3> dirty_chunks;
+	Rect2 collision_dirty_rect;
+	bool collision_dirty = false;
+	void apply_edit(const DeformationLayer::Edit &p_edit);
+	void flush_dirty_chunks();
+
+	Ref<HeightMapData> take_height_map_data(const Vector3 &chunk_pos) {
 		//auto hmap_data = reuse_pool.data_left() ? reuse_pool.read() : memnew(HeightMapData);
 		// take from reuse_pool if reuse_pool is not empty
 		Ref<HeightMapData> hmap_data;
@@ -51,9 +103,28 @@ protected:
 			DEBUG_PRINT_OFTEN("CREATE HEIGHTMAP DATA", chunk_pos);
 			hmap_data = memnew(HeightMapData);
 		}
-		create_tasks[chunk_pos] = WorkerThreadPool::get_singleton()->add_task(
-			callable_mp(this, &TerrainGenerator::create_chunk).bind(hmap_data, chunk_pos, grid_pos)
-		);
+		// scatter buffers live with the chunk -> created once, recycled through reuse_pool
+		if (server_mode) {
+			hmap_data->set_scatter_data(Ref<ScatterData>());
+		}
+		else if (WorldData::SCATTER_MESH.is_valid() && hmap_data->get_scatter_data().is_null()) {
+			hmap_data->set_scatter_data(memnew(ScatterData));
+		}
+		return hmap_data;
+	}
+
+	/*
+	* BAKED REGIONS -> chunks inside a pack are read from disk instead of generated
+	* only touched on the main thread, workers get the matching pack bound to their task
+	*/
+	Vector<Ref<RegionPack>> region_packs;
+	Ref<RegionPack> find_region_pack(const Vector3 &chunk_pos) const {
+		for (const Ref<RegionPack> &pack : region_packs) {
+			if (pack->has_chunk(chunk_pos) && pack->is_compatible()) {
+				return pack;
+			}
+		}
+		return Ref<RegionPack>();
 	}
 
 	/*
@@ -64,12 +135,72 @@ protected:
         return !_player_node_path.is_empty() ? cast_to<CharacterBody3D>(get_node(_player_node_path)) : nullptr;
     }
 	// calculate player chunk -> convert global position to grid position
-	Vector3 player_chunk;
-	Vector3 calculate_player_chunk() const {
-		Vector3 p_chunk = (get_player()->get_global_position() / WorldData::LENGTH).round();
+	static Vector3 calculate_chunk(const Vector3 &global_pos) {
+		Vector3 p_chunk = (global_pos / WorldData::LENGTH).round();
 		p_chunk.y = 0.0;
 		return p_chunk;
 	}
+	Vector3 calculate_player_chunk() const { return calculate_chunk(get_observer_node(observers[0])->get_global_position()); }
+
+	/*
+	* OBSERVERS -> chunks stay resident inside the union of every observer's render circle
+	* observer 0 is always the player (_player_node_path) and always has a collision patch
+	* observers with a layer mask own a lod ring drawn only on those render layers (one per viewport)
+	* observers without one (server clients, streaming anchors) only keep chunks resident
+	*/
+	struct Observer {
+		NodePath node_path;
+		uint32_t layer_mask = 0;
+		bool has_collision = false;
+		CollisionPatch collision;
+		// chunk the ring was last placed around -> only counts for interest while the node exists
+		Vector3 chunk;
+		bool active = false;
+		// precomputed lod meshes -> 2**LODS.center
+		HashMap<Vector2i, Ref<MeshData>> lod_meshes;
+	};
+	LocalVector<Observer> observers;
+	Node3D *get_observer_node(const Observer &p_observer) const {
+		return !p_observer.node_path.is_empty() ? cast_to<Node3D>(get_node_or_null(p_observer.node_path)) : nullptr;
+	}
+	void build_lod_ring(Observer &p_observer);
+	void clear_lod_ring(Observer &p_observer);
+	void build_collision(Observer &p_observer);
+	void clear_collision(Observer &p_observer);
+	void update_shape(Observer &p_observer, int x, int z);
+	// chunks missing from the interest circle -> observers without a ring are checked as well
+	int count_missing(const Vector3 &new_chunk, bool p_stop_at_first = false) const {
+		const int radius = get_interest_radius();
+		int missing = 0;
+		for (int z = -radius; z <= radius; z++) {
+			for (int x = -radius; x <= radius; x++) {
+				if (Vector3(x, 0, z).length() >= radius) continue;
+				if (chunk_table.has(new_chunk + Vector3(x, 0, z))) continue;
+				if (p_stop_at_first) return 1;
+				missing++;
+			}
+		}
+		return missing;
+	}
+	bool update_check(const Vector3 &new_chunk) const { return count_missing(new_chunk, true) > 0; }
+	// returns true if the observer changed chunk or queued new chunks
+	bool update_observer(Observer &p_observer);
+	// show a resident chunk in every ring that has a slot for it
+	// p_refresh_only -> only re-upload slots already showing this chunk (edits)
+	void place_chunk(const Ref<HeightMapData> &hmap_data, const Vector3 &chunk_pos, bool p_refresh_only = false);
+	// squared distance (chunks) to the nearest observer -> generation and integration priority
+	real_t interest_distance_squared(const Vector3 &chunk_pos) const {
+		real_t nearest = Math::INF;
+		for (const Observer &o : observers) {
+			if (!o.active) continue;
+			nearest = MIN(nearest, o.chunk.distance_squared_to(chunk_pos));
+		}
+		return nearest;
+	}
+	bool in_interest(const Vector3 &chunk_pos, int p_margin = 0) const {
+		const int radius = get_interest_radius() + p_margin;
+		return interest_distance_squared(chunk_pos) < radius * radius;
+	}
 
 	/*
 	* helper to get heights from nearest heightmap	
@@ -89,17 +220,181 @@ protected:
 	/*
 	CHUNK MANAGING MEMBERS
 	*/
-	// precomputed lod meshes -> 2**LODS.center
-	HashMap<Vector2i, Ref<MeshData>> lod_meshes;
 	// chunk master list -> only holds chunks that are not being processed
 	HashMap<Vector3, Ref<HeightMapData>> chunk_table;
+	// chunk whose heightmap bounds contain p_position -> padding shifts bounds by one step from the chunk grid
+	static Vector3 chunk_containing(const Vector3 &p_position) {
+		return Vector3(
+			Math::floor((p_position.x - WorldData::STEP_SIZE) / WorldData::LENGTH + 0.5), 0,
+			Math::floor((p_position.z - WorldData::STEP_SIZE) / WorldData::LENGTH + 0.5)
+		);
+	}
+	// collision and height queries only see refined chunks -> coarse heights are never collided with
+	const Ref<HeightMapData> *find_chunk_at(const Vector3 &p_position) const {
+		const Ref<HeightMapData> *hmap_data = chunk_table.getptr(chunk_containing(p_position));
+		return hmap_data != nullptr && (*hmap_data)->is_refined() ? hmap_data : nullptr;
+	}
+	bool is_chunk_final(const Vector3 &chunk_pos) const {
+		const Ref<HeightMapData> *hmap_data = chunk_table.getptr(chunk_pos);
+		return hmap_data != nullptr && (*hmap_data)->is_refined();
+	}
+	// queued chunks hold INVALID_TASK_ID, dispatched chunks hold the group task of their batch
 	HashMap<Vector3, uint64_t> create_tasks;
 
+	/*
+	* GENERATION BATCHES -> one WorkerThreadPool group task over the 2D tiles of several chunks
+	* nearest chunks come first, so their tiles are picked up first by every worker
+	*/
+	struct QueuedChunk {
+		Vector3 chunk_pos;
+		real_t distance = 0.0;
+		// valid -> second pass of a resident coarse chunk, dropped if that chunk was evicted meanwhile
+		Ref<HeightMapData> refine_data;
+		bool operator<(const QueuedChunk &p_other) const { return distance < p_other.distance; }
+	};
+	LocalVector<QueuedChunk> create_queue;
+
+	struct GenerationBatch {
+		struct Entry {
+			Ref<HeightMapData> hmap_data;
+			Ref<RegionPack> region_pack;
+			Vector3 chunk_pos;
+			Callable post_generation;
+		};
+		// baked chunks first (one element each), then generated chunks (tile count elements each)
+		LocalVector<Entry> baked;
+		LocalVector<Entry> generated;
+		WorkerThreadPool::GroupID group_id = -1;
+
+		uint32_t size() const { return baked.size() + generated.size(); }
+		uint32_t get_element_count(uint32_t p_tile_count) const { return baked.size() + generated.size() * p_tile_count; }
+		// Only for worker threads
+		void generate_element(uint32_t p_index, uint32_t p_tile_count);
+	};
+	LocalVector<GenerationBatch *> generation_batches;
+	static constexpr uint32_t MAX_BATCHES_IN_FLIGHT = 2;
+	// queued chunks handed to HeightSource::prefetch, in batches -> streaming sources read ahead of generation
+	static constexpr uint32_t READ_AHEAD_BATCHES = 3;
+	static constexpr int MIN_TILE_SIZE = 16;
+	// 0 -> auto-tune from H_RESOLUTION and worker count
+	int tile_size_override = 0;
+	void tune_tile_size();
+	void dispatch_generation_batches();
+	void wait_generation_batches();
+
+	/*
+	* FAR-FIELD HORIZON -> coarse ring beyond render_distance around the player (observer 0)
+	* settings are applied when the horizon is (re)built -> _ready or set_horizon_enabled
+	*/
+	Ref<HorizonData> horizon;
+	bool horizon_enabled = false;
+	Ref<Shader> horizon_shader;
+	// covered square side in multiples of the chunk ring diameter
+	real_t horizon_scale = 8.0;
+	int horizon_resolution = 256;
+	int horizon_octaves = 3;
+	// share of the full height range the horizon is sunk by under the chunk rings
+	static constexpr real_t HORIZON_SINK_FRACTION = 0.05;
+	void build_horizon();
+	void update_horizon_sink();
+
+	/*
+	* TERRAIN REQUESTS -> regions gameplay code waits on (spawn points, teleport targets)
+	* requested chunks are pinned: generated and integrated before anything else, never dropped or evicted
+	* completed requests stay pinned (with their collision patch) until the caller drops the TerrainRequest
+	*/
+	struct PendingRequest {
+		Ref<TerrainRequest> request;
+		LocalVector<Vector3> chunks;
+		CollisionPatch patch;
+	};
+	LocalVector<PendingRequest> requests;
+	// number of requests pinning each chunk
+	HashMap<Vector3, int> pinned_chunks;
+	bool is_pinned(const Vector3 &chunk_pos) const { return pinned_chunks.has(chunk_pos); }
+	// pinned chunks sort before every observer chunk
+	real_t get_priority(const Vector3 &chunk_pos) const { return is_pinned(chunk_pos) ? -1.0 : interest_distance_squared(chunk_pos); }
+	void update_requests();
+	void release_request(uint32_t p_index);
+	// collision patch quads per side -> one per height step, at least collision_size, capped for huge radii
+	int get_request_quads(real_t p_radius) const {
+		return CLAMP(int(Math::ceil(2.0 * p_radius / WorldData::STEP_SIZE)), int(collision_size.x / WorldData::STEP_SIZE), 256);
+	}
+
+	/*
+	* READY QUEUE -> finished chunks waiting for main thread integration
+	* workers append under ready_mutex, main thread drains nearest first within integration_budget_usec
+	*/
+	struct ReadyChunk {
+		Ref<HeightMapData> hmap_data;
+		Vector3 chunk_pos;
+		real_t distance = 0.0;
+		// finished refinement pass of a resident chunk -> swapped in instead of added
+		bool refinement = false;
+		bool operator<(const ReadyChunk &p_other) const { return distance < p_other.distance; }
+	};
+	Mutex ready_mutex;
+	LocalVector<ReadyChunk> ready_chunks;
+	// main thread only -> chunks carried over from previous frames
+	LocalVector<ReadyChunk> pending_chunks;
+	uint64_t integration_budget_usec = 2000;
+	void integrate_ready_chunks();
+
+	/*
+	* INITIAL BURST -> chunks around each observer are queued in _ready and dispatched as one batch
+	* they are integrated without integration_budget_usec, so the first frames show the nearest terrain at once
+	*/
+	int initial_burst_radius = 2;
+	HashSet<Vector3> burst_chunks;
+	void queue_initial_burst();
+
+	/*
+	* PROGRESSIVE REFINEMENT -> new chunks are generated coarse (HeightMapData::REFINE_STRIDE) and shown at once
+	* the refinement pass is queued behind every missing chunk, collision waits for the refined heights
+	* chunks under collision or navigation skip the coarse pass -> they are final as soon as they arrive
+	* off in server mode -> nothing is drawn, so only final heights are generated
+	*/
+	bool progressive_refinement = true;
+	// added to the priority of refinement passes -> any missing chunk is generated first
+	static constexpr real_t REFINE_PRIORITY_OFFSET = 1e6;
+	bool is_progressive() const { return progressive_refinement && !server_mode; }
+	// collision 2x2 of an observer or a navigation tile -> generated final in one pass, refined ahead of everything
+	bool needs_final_heights(const Vector3 &chunk_pos) const {
+		if (navigation_enabled && in_navigation_radius(chunk_pos)) {
+			return true;
+		}
+		for (const Observer &o : observers) {
+			if (o.active && o.has_collision && MAX(Math::abs(chunk_pos.x - o.chunk.x), Math::abs(chunk_pos.z - o.chunk.z)) <= 1.0) {
+				return true;
+			}
+		}
+		return false;
+	}
+	void apply_refinement(const Ref<HeightMapData> &hmap_data, const Vector3 &chunk_pos);
+
+	/*
+	* NAVIGATION -> final chunks within navigation_radius of an observer get a navmesh tile baked from their heights
+	* tiles are re-baked after edits and released once the chunk leaves the radius or is evicted
+	*/
+	NavigationLayer navigation;
+	bool navigation_enabled = false;
+	int navigation_radius = 2;
+	// observers moved or navigation was enabled -> resident chunks entering the radius are queued
+	bool navigation_scan = false;
+	bool in_navigation_radius(const Vector3 &chunk_pos) const {
+		return interest_distance_squared(chunk_pos) < navigation_radius * navigation_radius;
+	}
+	void queue_navigation(const Ref<HeightMapData> &hmap_data, const Vector3 &chunk_pos);
+	void update_navigation();
+
 protected:
 	// Only for worker threads
-	void create_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos, Vector2i grid_pos);
+	void finish_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos);
+	void finish_refinement(Ref<HeightMapData> hmap_data, Vector3 chunk_pos);
+	void scatter_element(uint32_t p_index, HeightMapData **p_chunks);
 	// Only for main thread
-	void add_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos, Vector2i grid_pos);
+	void add_chunk(Ref<HeightMapData> hmap_data, Vector3 chunk_pos);
+	void scatter_missing(const Ref<HeightMapData> &hmap_data);
 	void delete_far_away_chunks();
 
 	static void _bind_methods();
@@ -126,23 +421,153 @@ public:
 	void set_step_size(const int8_t &new_step_exp) {
 		WorldData::STEP_EXP = new_step_exp;
 		WorldData::STEP_SIZE = 1 << WorldData::STEP_EXP;
+		WorldData::H_RESOLUTION = (1 << (WorldData::LENGTH_EXP - WorldData::STEP_EXP)) + 1 + 2;
 	}
 	void set_length(const int8_t &new_length_exp) {
 		WorldData::LENGTH_EXP = new_length_exp;
 		WorldData::LENGTH = 1 << WorldData::LENGTH_EXP;
+		WorldData::H_RESOLUTION = (1 << (WorldData::LENGTH_EXP - WorldData::STEP_EXP)) + 1 + 2;
 	}
+	// applied on the next _ready -> tile layout must not change while batches are running
+	void set_tile_size(const int &p_tile_size) { tile_size_override = MAX(p_tile_size, 0); }
+	int get_tile_size() const { return WorldData::TILE_SIZE; }
 	void set_render_distance(const int &new_render_distance) { render_distance = new_render_distance; }
-	void set_seed(const int &new_seed) { seed = new_seed; }
+	// scatter cells are hashed with WorldData::SEED -> only chunks generated afterwards
+	void set_seed(const int &new_seed) {
+		seed = new_seed;
+		WorldData::SEED = seed;
+	}
+	// main thread time per frame spent integrating finished chunks -> at least one chunk is always integrated
+	void set_integration_budget_usec(const int &p_usec) { integration_budget_usec = MAX(p_usec, 0); }
+	int get_integration_budget_usec() const { return integration_budget_usec; }
+	void set_initial_burst_radius(const int &p_radius) { initial_burst_radius = MAX(p_radius, 0); }
+	int get_initial_burst_radius() const { return initial_burst_radius; }
+	// only affects chunks generated afterwards
+	void set_progressive_refinement(const bool &p_enabled) { progressive_refinement = p_enabled; }
+	bool is_progressive_refinement() const { return progressive_refinement; }
+
+	// NAVIGATION
+	void set_navigation_enabled(const bool &p_enabled);
+	bool is_navigation_enabled() const { return navigation_enabled; }
+	void set_navigation_radius(const int &p_radius) { navigation_radius = MAX(p_radius, 1); navigation_scan = true; }
+	int get_navigation_radius() const { return navigation_radius; }
+	// agent and cell settings of every tile -> only affects tiles baked afterwards
+	void set_navigation_mesh(const Ref<NavigationMesh> &p_navigation_mesh) { navigation.set_template(p_navigation_mesh); }
+	Ref<NavigationMesh> get_navigation_mesh() const { return navigation.get_template(); }
+	void set_navigation_layers(const int &p_layers) { navigation.set_navigation_layers(p_layers); }
+	int get_navigation_layers() const { return navigation.get_navigation_layers(); }
+	void set_navigation_sample_step(const int &p_step) { navigation.set_sample_step(p_step); }
+	int get_navigation_sample_step() const { return navigation.get_sample_step(); }
+	int get_navigation_tile_count() const { return navigation.get_tile_count(); }
+
+	// SERVER MODE -> switching rebuilds the terrain
+	void set_server_mode(const bool &p_enabled);
+	bool is_server_mode() const { return server_mode; }
+	void set_server_radius(const int &p_radius) { server_radius = MAX(p_radius, 1); }
+	int get_server_radius() const { return server_radius; }
+	void set_server_eviction_margin(const int &p_margin) { server_eviction_margin = MAX(p_margin, 0); }
+	int get_server_eviction_margin() const { return server_eviction_margin; }
+
+	// HEIGHT QUERIES -> resident chunks only, NAN elsewhere
+	bool is_position_resident(const Vector3 &p_position) const { return find_chunk_at(p_position) != nullptr; }
+	real_t get_height_at(const Vector3 &p_position) const;
+	Vector3 get_normal_at(const Vector3 &p_position) const;
 
 	// PARAMETERS (DYNAMIC)
 	void set_player_node_path(const NodePath &p_path);
+	void set_player_layer_mask(const int &p_layer_mask);
+	int get_player_layer_mask() const { return observers[0].layer_mask; }
+
+	// OBSERVERS
+	bool add_observer(const NodePath &p_path, const int &p_layer_mask = 0, const bool &p_collision = false);
+	bool remove_observer(const NodePath &p_path);
+	int get_observer_count() const { return observers.size(); }
 	void set_terrain_shader(Ref<Shader> p_shader);
+	void set_height_source(const Ref<HeightSource> &p_source);
 	void set_terrain_offset(const Vector3 &p_pos);
 	void set_terrain_amplitude(const real_t &new_amp);
 	void set_terrain_height_exp(const real_t &new_height_exp);
 
+	// VEGETATION SCATTER
+	Ref<Mesh> scatter_mesh;
+	void set_scatter_mesh(const Ref<Mesh> &p_mesh);
+	// refined chunk that finished or was created while the scatter mesh was unset
+	bool needs_scatter(const Ref<HeightMapData> &hmap_data) const {
+		if (server_mode || !WorldData::SCATTER_MESH.is_valid() || !hmap_data->is_refined()) {
+			return false;
+		}
+		return hmap_data->get_scatter_data().is_null() || !hmap_data->get_scatter_data()->is_scattered();
+	}
+	void set_scatter_spacing(const real_t &p_spacing) { WorldData::SCATTER_SPACING = MAX(p_spacing, (real_t)WorldData::STEP_SIZE); }
+	void set_scatter_density(const real_t &p_density) { WorldData::SCATTER_DENSITY = CLAMP(p_density, 0.0, 1.0); }
+	void set_scatter_height_range(const Vector2 &p_range) {
+		WorldData::SCATTER_MIN_HEIGHT = p_range.x;
+		WorldData::SCATTER_MAX_HEIGHT = p_range.y;
+	}
+	void set_scatter_max_slope(const real_t &p_slope) { WorldData::SCATTER_MAX_SLOPE = p_slope; }
+	void set_scatter_scale_range(const Vector2 &p_range) {
+		WorldData::SCATTER_MIN_SCALE = p_range.x;
+		WorldData::SCATTER_MAX_SCALE = p_range.y;
+	}
+
+	Ref<Mesh> get_scatter_mesh() const { return scatter_mesh; }
+	real_t get_scatter_spacing() const { return WorldData::SCATTER_SPACING; }
+	real_t get_scatter_density() const { return WorldData::SCATTER_DENSITY; }
+	Vector2 get_scatter_height_range() const { return Vector2(WorldData::SCATTER_MIN_HEIGHT, WorldData::SCATTER_MAX_HEIGHT); }
+	real_t get_scatter_max_slope() const { return WorldData::SCATTER_MAX_SLOPE; }
+	Vector2 get_scatter_scale_range() const { return Vector2(WorldData::SCATTER_MIN_SCALE, WorldData::SCATTER_MAX_SCALE); }
+
+	// DEFORMATION
+	void raise_terrain(const Vector3 &p_center, const real_t &p_radius, const real_t &p_amount) {
+		apply_edit({ DeformationLayer::EDIT_RAISE, p_center, p_radius, p_amount });
+	}
+	void flatten_terrain(const Vector3 &p_center, const real_t &p_radius, const real_t &p_height) {
+		apply_edit({ DeformationLayer::EDIT_FLATTEN, p_center, p_radius, p_height });
+	}
+	int get_deformed_chunk_count() const { return deformation.get_delta_count(); }
+
+	// STREAMING STATS -> chunks in the player's circle that are not resident
+	int get_missing_chunk_count() const {
+		if (get_observer_node(observers[0]) == nullptr) return 0;
+		return count_missing(calculate_player_chunk());
+	}
+	int get_queued_chunk_count() const { return create_tasks.size(); }
+
+	// FAR-FIELD HORIZON
+	void set_horizon_enabled(const bool &p_enabled);
+	void set_horizon_shader(const Ref<Shader> &p_shader);
+	void set_horizon_scale(const real_t &p_scale) { horizon_scale = MAX(p_scale, (real_t)1.0); }
+	void set_horizon_resolution(const int &p_resolution) { horizon_resolution = CLAMP(p_resolution, 16, 2048); }
+	void set_horizon_octaves(const int &p_octaves) { horizon_octaves = MAX(p_octaves, 1); }
+	bool is_horizon_enabled() const { return horizon_enabled; }
+	Ref<Shader> get_horizon_shader() const { return horizon_shader; }
+	real_t get_horizon_scale() const { return horizon_scale; }
+	int get_horizon_resolution() const { return horizon_resolution; }
+	int get_horizon_octaves() const { return horizon_octaves; }
+
+	// TERRAIN REQUESTS
+	Ref<TerrainRequest> request_region(const Vector3 &p_position, const real_t &p_radius, const bool &p_collision = false);
+	void cancel_request(const Ref<TerrainRequest> &p_request);
+	int get_request_count() const { return requests.size(); }
+
+	// PIPELINE TRACE -> process wide, shared by every TerrainGenerator
+	void set_trace_enabled(const bool &p_enabled) { TerrainTrace::set_enabled(p_enabled); }
+	bool is_trace_enabled() const { return TerrainTrace::is_enabled(); }
+	void clear_trace() { TerrainTrace::clear(); }
+	String get_trace_json() const { return TerrainTrace::to_json(); }
+	Error save_trace(const String &p_file) const { return TerrainTrace::save(p_file); }
+
+	// BAKED REGIONS
+	Error add_region_pack(const String &p_path);
+	void clear_region_packs() { region_packs.clear(); }
+	int get_region_pack_count() const { return region_packs.size(); }
+	Error bake_region(const String &p_path, const Rect2i &p_region, bool p_fast_compression = false, int p_shard = 0, int p_shard_count = 1) {
+		return RegionPack::bake(p_path, p_region, p_fast_compression, p_shard, p_shard_count);
+	}
+
 	NodePath get_player_node_path() const { return _player_node_path; }
 	Ref<Shader> get_terrain_shader() const { return WorldData::terrain_shader; }
+	Ref<HeightSource> get_height_source() const { return WorldData::height_source; }
 	Vector3 get_terrain_offset() const { return WorldData::WORLD_OFFSET; };
 	real_t get_terrain_amplitude() const { return WorldData::AMPLITUDE; }
 	real_t get_terrain_height_exp() const { return WorldData::HEIGHT_EXP; }
@@ -159,4 +584,5 @@ public:
 		ready_queued.store(true);
 		_ready();
 	}
+	void height_source_changed();
 };
\ No newline at end of file